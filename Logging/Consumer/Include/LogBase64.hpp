@@ -0,0 +1,84 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogToOutput.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+/// @brief Length of an encoded log message, prefix included
+#define LOG_BASE64_ENCODED_LENGTH(length)   (1 + ((((length) + 2) / 3) * 4))
+
+// ----------------------------------------------------------------------------
+// Class definition
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Encodes the tokenized log messages in Base64, for the consumers which output text.
+ *
+ * The encoded messages start with the '$' prefix and are padded, as pw_tokenizer's PrefixedBase64Encode()
+ * does, so that the pigweed detokenizer decodes them. The blocks of 3 bytes are encoded with SSSE3, AVX2
+ * or AArch64 NEON when the compiler targets them, and with a lookup table otherwise.
+ */
+class LogBase64
+{
+public:
+    // Prefix of the encoded log messages
+    static constexpr char cPrefix = '$';
+
+    // Size of the buffer of an encoded log message, for the longest log message
+    static constexpr size_t cMessageSize = LOG_BASE64_ENCODED_LENGTH(CONFIG_COMMONS_LOGGING_BUFFER_SIZE);
+
+    /**
+     * @brief Encodes a log message split in segments, as if they were contiguous.
+     *
+     * The encoded message is not null terminated.
+     *
+     * @param[in] pSegments Pointer to the segments of the log message.
+     * @param[in] segmentCount Number of segments.
+     * @param[out] pOutput Pointer to the buffer receiving the encoded message.
+     * @param[in] size Size of the buffer in bytes.
+     *
+     * @return size_t Returns the length of the encoded message, or 0 if it does not fit in the buffer.
+     */
+    static size_t Encode(const LogSpan_t* pSegments, size_t segmentCount, char* pOutput, size_t size);
+
+    /**
+     * @brief Encodes a batch of log messages in one pass.
+     *
+     * The encoded records keep the metadata of the log messages, and point to the encoded messages.
+     * A log message which does not fit in its buffer is kept as is.
+     *
+     * @param[in] pRecords Pointer to the log messages.
+     * @param[in] recordCount Number of log messages, up to CONFIG_COMMONS_LOGGING_BATCH_SIZE.
+     * @param[out] pEncodedRecords Pointer to the records receiving the encoded log messages.
+     * @param[out] pMessages Pointer to the buffers receiving the encoded messages, one per log message.
+     */
+    static void EncodeBatch(const LogRecord_t* pRecords, size_t recordCount, LogRecord_t* pEncodedRecords,
+                            char (*pMessages)[cMessageSize]);
+
+private:
+    /**
+     * @brief Encodes the whole blocks of 3 bytes at the start of the data.
+     *
+     * @param[in] pInput Pointer to the data.
+     * @param[in] length Length of the data in bytes.
+     * @param[out] pOutput Pointer to the buffer receiving 4 characters per encoded block.
+     *
+     * @return size_t Number of bytes encoded, a multiple of 3.
+     */
+    static size_t EncodeBlocks(const uint8_t* pInput, size_t length, char* pOutput);
+};
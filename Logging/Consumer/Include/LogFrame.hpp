@@ -0,0 +1,79 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogFrameFormat.h"
+#include "LogToOutput.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+// Class definition
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Frames the tokenized log messages with their metadata, for the consumers which output binary links.
+ *
+ * A frame is the COBS encoding of the level, the sequence number, the timestamp, the tokenized log message
+ * and its CRC, followed by a zero byte, see LogFrameFormat.h. COBS adds one byte per 254 bytes, against
+ * a third of the size for Base64, and a decoder resynchronizes on the next zero byte after any corruption.
+ */
+class LogFrame
+{
+public:
+    // Size of the buffer of a frame, for the longest log message
+    static constexpr size_t cFrameSize = LOG_FRAME_ENCODED_SIZE(LOG_FRAME_MAX_PAYLOAD_SIZE(CONFIG_COMMONS_LOGGING_BUFFER_SIZE));
+
+    /**
+     * @brief Frames a log message with its metadata.
+     *
+     * @param[in] record The log message and its metadata.
+     * @param[out] pOutput Pointer to the buffer receiving the frame, delimiter included.
+     * @param[in] size Size of the buffer in bytes.
+     *
+     * @return size_t Returns the length of the frame, or 0 if it does not fit in the buffer.
+     */
+    static size_t Encode(const LogRecord_t& record, uint8_t* pOutput, size_t size);
+
+    /**
+     * @brief Frames a batch of log messages in one pass.
+     *
+     * The framed records keep the metadata of the log messages, and point to the frames.
+     * A log message which does not fit in its buffer is dropped and counted, the next ones move up.
+     *
+     * @param[in] pRecords Pointer to the log messages.
+     * @param[in] recordCount Number of log messages, up to CONFIG_COMMONS_LOGGING_BATCH_SIZE.
+     * @param[out] pFramedRecords Pointer to the records receiving the frames.
+     * @param[out] pFrames Pointer to the buffers receiving the frames, one per log message.
+     *
+     * @return size_t Number of framed records.
+     */
+    static size_t EncodeBatch(const LogRecord_t* pRecords, size_t recordCount, LogRecord_t* pFramedRecords,
+                              uint8_t (*pFrames)[cFrameSize]);
+
+    /**
+     * @brief Count a log message dropped as it does not fit in a frame.
+     */
+    static void CountDroppedLog();
+
+    /**
+     * @brief Get the number of log messages dropped as they did not fit in a frame, since the start.
+     *
+     * @return uint32_t Number of log messages, wraps around.
+     */
+    static uint32_t GetDroppedCount();
+
+private:
+
+    inline static std::atomic<uint32_t> mDroppedCount = 0;  // Number of log messages which did not fit in a frame
+};
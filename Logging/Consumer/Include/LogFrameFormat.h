@@ -0,0 +1,94 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+#pragma once
+
+/*
+ * Binary framing of the tokenized log messages, shared by the encoder of the logging core and the host decoders.
+ *
+ * A frame is the COBS encoding of the payload, followed by a zero byte. The payload holds no zero byte once
+ * encoded, so the decoder finds the start of the next frame after any corruption. The payload is encoded as:
+ *  - 1 byte: level, timestamp flag and CRC flag, the reserved bits are always zero
+ *  - 1 to 5 bytes: sequence number of the log message, as a base 128 varint
+ *  - 1 to 10 bytes: timestamp of the log message in ticks, as a base 128 varint, only with the timestamp flag
+ *  - the tokenized log message, up to the CRC
+ *  - 2 bytes: CRC-16/CCITT-FALSE of the previous bytes, little endian, only with the CRC flag
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+// Byte ending every frame
+#define LOG_FRAME_DELIMITER         0x00
+
+// First byte of the payload
+#define LOG_FRAME_LEVEL_MASK        0x0F
+#define LOG_FRAME_TIMESTAMP_FLAG    0x10
+#define LOG_FRAME_CRC_FLAG          0x20
+#define LOG_FRAME_RESERVED_MASK     0xC0
+
+// A 32 bit varint takes at most 5 bytes and a 64 bit varint 10 bytes
+#define LOG_FRAME_MAX_SEQUENCE_NUMBER_SIZE  5
+#define LOG_FRAME_MAX_TIMESTAMP_SIZE        10
+
+// CRC of the payload
+#define LOG_FRAME_CRC_INITIAL_VALUE 0xFFFF
+#define LOG_FRAME_CRC_SIZE          2
+
+/// @brief Largest payload of a log message of the given length
+#define LOG_FRAME_MAX_PAYLOAD_SIZE(length)  (1 + LOG_FRAME_MAX_SEQUENCE_NUMBER_SIZE + LOG_FRAME_MAX_TIMESTAMP_SIZE + \
+                                             (length) + LOG_FRAME_CRC_SIZE)
+
+/// @brief Largest frame of a payload of the given size, COBS adds a code byte per 254 bytes and the delimiter
+#define LOG_FRAME_ENCODED_SIZE(size)        ((size) + ((size) / 254) + 2)
+
+// ----------------------------------------------------------------------------
+// Function definitions
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Updates the CRC-16/CCITT-FALSE of a payload with more bytes.
+ *
+ * The CRC is computed 4 bits at a time with a table of 16 entries. Start with LOG_FRAME_CRC_INITIAL_VALUE.
+ *
+ * @param[in] crc The CRC of the previous bytes.
+ * @param[in] pData Pointer to the bytes.
+ * @param[in] length Number of bytes.
+ *
+ * @return uint16_t The CRC of the previous bytes and the new ones.
+ */
+static inline uint16_t LogFrame_UpdateCrc(uint16_t crc, const uint8_t* pData, size_t length)
+{
+    static const uint16_t cCrcTable[16] =
+    {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    };
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        crc = (uint16_t)((crc << 4) ^ cCrcTable[(crc >> 12) ^ (pData[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ cCrcTable[(crc >> 12) ^ (pData[i] & 0x0F)]);
+    }
+
+    return crc;
+}
+
+#ifdef __cplusplus
+}
+#endif
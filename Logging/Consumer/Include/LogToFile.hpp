@@ -0,0 +1,152 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogToOutput.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// ----------------------------------------------------------------------------
+// Class definition
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Consumer which writes the log messages into memory mapped segment files, on Linux hosts.
+ *
+ * Every segment file is preallocated and mapped in memory, so a log message is a copy into the mapping
+ * and no system call. The pages are written back by the kernel, which is asked to start with msync(MS_ASYNC)
+ * every LOG_FILE_SYNC_SIZE bytes. The log messages survive a crash of the process, as they are in the page
+ * cache already.
+ *
+ * When a log message does not fit in the segment, the segment is truncated to its content and the next
+ * one is started. The segments are named "<path>.<index>", from 0, and only the last segmentCount ones
+ * are kept. The text log messages are written one per line, the framed ones as is.
+ */
+class LogToFile final: public LogToOutput
+{
+public:
+
+    using LogToOutput::ProcessLogMessage;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] pPath Path of the segment files, without their index.
+     * @param[in] segmentSize Size of a segment file in bytes, rounded up to a multiple of the page size.
+     * @param[in] segmentCount Number of segment files kept, 0 to keep them all.
+     */
+    LogToFile(const char* pPath, size_t segmentSize, size_t segmentCount);
+
+    /**
+     * @brief Destructor, closes the segment file.
+     */
+    ~LogToFile();
+
+    /**
+     * @brief Initialization, opens the first segment file.
+     */
+    void Initialize() override;
+
+    /**
+     * @brief Process a log message and copy it into the segment file.
+     *
+     * @param[in] pMessage Pointer to the log message.
+     * @param[in] length Length of the log message.
+     */
+    void ProcessLogMessage(const uint8_t* pMessage, size_t length) override;
+
+    /**
+     * @brief Process a log message split in multiple segments and copy them into the segment file.
+     *
+     * @param[in] pSegments Pointer to the segments of the log message.
+     * @param[in] segmentCount Number of segments.
+     */
+    void ProcessLogMessage(const LogSpan_t* pSegments, size_t segmentCount) override;
+
+#if CONFIG_COMMONS_LOGGING_TOKENIZED
+    /**
+     * @brief Receive the tokenized log messages framed, or Base64 encoded without framing.
+     *
+     * @return LogOutputFormat_t LOG_OUTPUT_FORMAT_FRAMED with CONFIG_COMMONS_LOGGING_FRAMING,
+     *                           LOG_OUTPUT_FORMAT_BASE64 otherwise.
+     */
+    LogOutputFormat_t GetOutputFormat() const override;
+#endif
+
+    /**
+     * @brief Closes the segment file, truncated to its content.
+     *
+     * To be called once no log message is processed anymore, eg: after LogCore::Flushlogs() at exit.
+     * A segment file which is not closed keeps its zero filled end. A later log message opens the next one.
+     */
+    void Close();
+
+    /**
+     * @brief Get the error of the last segment file which could not be opened.
+     *
+     * @return int Returns 0 if all segment files were opened, otherwise the negative error code.
+     */
+    int GetLastError() const;
+
+    /**
+     * @brief Get the number of log messages dropped as no segment file is open.
+     *
+     * While no segment file can be opened, a new attempt is made at most once per LOG_FILE_RETRY_INTERVAL_MS.
+     *
+     * @return uint64_t Number of log messages.
+     */
+    uint64_t GetDroppedCount() const;
+
+private:
+
+    /**
+     * @brief Copies a log message into the segment file, starting the next segment file if needed.
+     *
+     * @param[in] pSegments Pointer to the segments of the log message.
+     * @param[in] segmentCount Number of segments.
+     */
+    void Write(const LogSpan_t* pSegments, size_t segmentCount);
+
+    /**
+     * @brief Opens and maps the segment file of the next index, and removes the oldest one.
+     *
+     * @return int Returns 0 on success, otherwise the negative error code.
+     */
+    int OpenSegment();
+
+    /**
+     * @brief Unmaps the segment file, and truncates it to its content.
+     */
+    void CloseSegment();
+
+    /**
+     * @brief Asks the kernel to write back the log messages written since the last call, without waiting.
+     */
+    void Sync();
+
+    std::string             mPath;                  // Path of the segment files, without their index
+    size_t                  mSegmentSize;           // Size of a segment file in bytes
+    size_t                  mSegmentCount;          // Number of segment files kept, 0 to keep them all
+    size_t                  mPageSize;              // Page size, the alignment of msync()
+    uint32_t                mSegmentIndex = 0;      // Index of the next segment file
+    int                     mFd = -1;               // File descriptor of the segment file, -1 if none is open
+    uint8_t*                mpSegment = nullptr;    // Mapping of the segment file, nullptr if none is open
+    size_t                  mOffset = 0;            // Number of bytes written in the segment file
+    size_t                  mSyncOffset = 0;        // Number of bytes of the segment file already synced
+    uint64_t                mOpenTimeMs = 0;        // Time of the last attempt to open a segment file
+    std::atomic<int>        mLastError = 0;         // Error of the last segment file which could not be opened
+    std::atomic<uint64_t>   mDroppedCount = 0;      // Number of log messages dropped as no segment file is open
+    std::mutex              mMutex;                 // Producers in immediate mode, the log thread and the panic mode write concurrently
+};
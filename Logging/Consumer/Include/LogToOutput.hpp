@@ -10,13 +10,60 @@
 // Header includes
 // ----------------------------------------------------------------------------
 
-#if CONFIG_COMMONS_LOGGING_BASE64_ENCODING
-    #include "Assert.h"
-    #include <pw_tokenizer/base64.h>
+#include "LogSource.h"
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    #include "LogTimestamp.h"
 #endif
 
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+// Number of read cursors in the log queues. With CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS,
+// every consumer reads the log queues at its own pace, otherwise the consumers share one cursor.
+#if CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS
+    #define LOG_CURSOR_COUNT    CONFIG_COMMONS_LOGGING_MAX_CONSUMERS
+#else
+    #define LOG_CURSOR_COUNT    (1)
+#endif
+
+// ----------------------------------------------------------------------------
+// Datatype definitions
+// ----------------------------------------------------------------------------
+
+typedef struct
+{
+    const uint8_t*  pData;      // Pointer to the data
+    size_t          length;     // Length of the data
+} LogSpan_t;
+
+typedef struct
+{
+    LogSpan_t   segments[2];        // Log message, split in two segments when it wraps around the queue buffer
+    size_t      segmentCount;       // Number of valid segments
+    int         level;              // Log level
+    uint32_t    sequenceNumber;     // Sequence number for the log message, in queuing order across all the log queues
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+    LogSource_t source;             // Module, file and line of the log message, rendered as prefix by the consumer
+#endif
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    uint64_t    timestamp;          // Time of the log message, in ticks of LogTimestamp_GetFrequency()
+#endif
+} LogRecord_t;
+
+#if CONFIG_COMMONS_LOGGING_TOKENIZED
+// Output format of the tokenized log messages received by a consumer
+typedef enum
+{
+    LOG_OUTPUT_FORMAT_BINARY,   // Tokenized log messages as is
+    LOG_OUTPUT_FORMAT_BASE64,   // Base64 text with the '$' prefix, with CONFIG_COMMONS_LOGGING_BASE64_ENCODING
+    LOG_OUTPUT_FORMAT_FRAMED,   // COBS frames carrying the metadata, with CONFIG_COMMONS_LOGGING_FRAMING
+} LogOutputFormat_t;
+#endif
 
 // ----------------------------------------------------------------------------
 // Class definition
@@ -47,46 +94,114 @@ public:
      */
     virtual void ProcessLogMessage(const uint8_t* pMessage, size_t length) = 0;
 
-    void SetId(uint8_t id)
+    /**
+     * @brief Process a log message split in multiple segments.
+     *
+     * This function is called in deferred mode, the segments point directly into the log queue.
+     * The default implementation joins the segments and calls the single buffer variant. Consumers
+     * which can output the segments one after another should override it to avoid the copy.
+     *
+     * @param[in] pSegments Pointer to the segments of the log message.
+     * @param[in] segmentCount Number of segments.
+     */
+    virtual void ProcessLogMessage(const LogSpan_t* pSegments, size_t segmentCount)
     {
-        mId = id;
-    }
-
-private:
+        if (segmentCount == 1)
+        {
+            ProcessLogMessage(pSegments[0].pData, pSegments[0].length);
+            return;
+        }
 
-    uint8_t     mId;    // Unique identifier for the consumer
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+        uint8_t message[LOG_SOURCE_PREFIX_MAX_LENGTH + CONFIG_COMMONS_LOGGING_BUFFER_SIZE];
+#else
+        uint8_t message[CONFIG_COMMONS_LOGGING_BUFFER_SIZE];
+#endif
+        size_t length = 0;
+        for (size_t i = 0; i < segmentCount; ++i)
+        {
+            size_t segmentLength = pSegments[i].length;
+            if (segmentLength > (sizeof(message) - length))
+            {
+                segmentLength = sizeof(message) - length;
+            }
+
+            memcpy(&message[length], pSegments[i].pData, segmentLength);
+            length += segmentLength;
+        }
 
-protected:
+        if (length > 0)
+        {
+            ProcessLogMessage(message, length);
+        }
+    }
 
-#if CONFIG_COMMONS_LOGGING_BASE64_ENCODING
     /**
-     * @brief Converts the raw log message to a Base64 encoded string.
+     * @brief Process a batch of log messages.
      *
-     * @param[in] pRawMessage Pointer to the raw log message data.
-     * @param[in] rawMessageLength Length of the raw log message data.
-     * @param[in] base64MessageLength Reference to store the length of the Base64 encoded message.
+     * This function is called in deferred mode with up to CONFIG_COMMONS_LOGGING_BATCH_SIZE
+     * log messages at once, in the order they were logged. The default implementation processes
+     * them one by one. Consumers which can output them with a single write (eg: writev or DMA)
+     * should override it.
      *
-     * @return Pointer to the Base64 encoded message buffer, or nullptr if encoding fails.
+     * With structured prefix or timestamps, it is also called with a single log message in immediate mode.
+     * The default implementation renders the prefix in front of every log message, binary
+     * consumers may override it to output the metadata of the records as is.
+     *
+     * @param[in] pRecords Pointer to the log messages.
+     * @param[in] recordCount Number of log messages.
      */
-    const char* ConvertToBase64(const uint8_t* pRawMessage, size_t rawMessageLength, size_t &base64MessageLength)
+    virtual void ProcessLogBatch(const LogRecord_t* pRecords, size_t recordCount)
     {
-        ASSERT(pRawMessage != nullptr);
-        ASSERT(rawMessageLength > 0);
-
-        const size_t cBase64Size = pw::tokenizer::Base64EncodedBufferSize(rawMessageLength);
-        if (cBase64Size > mBase64BufferSize)
+        for (size_t i = 0; i < recordCount; ++i)
         {
-            return nullptr;
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+            char prefix[LOG_SOURCE_PREFIX_MAX_LENGTH];
+            LogSpan_t segments[3];
+
+            segments[0].pData = reinterpret_cast<const uint8_t*>(prefix);
+            segments[0].length = LogSource_FormatPrefix(prefix, sizeof(prefix), pRecords[i].level, &pRecords[i].source);
+            for (size_t j = 0; j < pRecords[i].segmentCount; ++j)
+            {
+                segments[j + 1] = pRecords[i].segments[j];
+            }
+
+            ProcessLogMessage(segments, pRecords[i].segmentCount + 1);
+#else
+            ProcessLogMessage(pRecords[i].segments, pRecords[i].segmentCount);
+#endif
         }
+    }
 
-        base64MessageLength = pw::tokenizer::PrefixedBase64Encode(pw::span(pRawMessage, rawMessageLength),
-                                                                  pw::span(mBase64Buffer));
-        ASSERT(base64MessageLength == (cBase64Size - 1));
+#if CONFIG_COMMONS_LOGGING_TOKENIZED
+    /**
+     * @brief Tells in which format the consumer outputs the tokenized log messages.
+     *
+     * The log messages are encoded once for all the consumers which use the same format, before
+     * they are processed. With LOG_OUTPUT_FORMAT_BASE64, the consumer receives them as text with the
+     * '$' prefix. With LOG_OUTPUT_FORMAT_FRAMED, it receives every record as one frame, ending with
+     * its delimiter, which carries the level, the sequence number and the timestamp. A format which
+     * is not enabled in the configuration receives them as is.
+     *
+     * @return LogOutputFormat_t The format of the log messages received by the consumer.
+     */
+    virtual LogOutputFormat_t GetOutputFormat() const
+    {
+        return LOG_OUTPUT_FORMAT_BINARY;
+    }
+#endif
 
-        return mBase64Buffer;
+    void SetId(uint8_t id)
+    {
+        mId = id;
     }
 
-    static constexpr size_t mBase64BufferSize = pw::tokenizer::Base64EncodedBufferSize(CONFIG_COMMONS_LOGGING_BUFFER_SIZE) + 1;
-    char mBase64Buffer[mBase64BufferSize];
-#endif // CONFIG_COMMONS_LOGGING_BASE64_ENCODING
+    uint8_t GetId() const
+    {
+        return mId;
+    }
+
+private:
+
+    uint8_t     mId;    // Unique identifier for the consumer
 };
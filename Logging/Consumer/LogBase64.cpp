@@ -0,0 +1,266 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "Assert.h"
+#include "LogBase64.hpp"
+
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// Variable definitions
+// ----------------------------------------------------------------------------
+
+// Character of every 6 bit value
+static const char cBase64Table[64] =
+{
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
+    'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
+    'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v',
+    'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/',
+};
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+/**
+ * @brief Splits the 4 blocks of 3 bytes at the start of the input into 16 values of 6 bits, one per byte.
+ *
+ * The 3 bytes of a block are spread over a 32 bit word, and the 4 values are shifted in place
+ * with multiplications, see W. Mula and D. Lemire, "Faster Base64 Encoding and Decoding using AVX2 Instructions".
+ *
+ * @param[in] input The input, its last 4 bytes are ignored.
+ *
+ * @return __m128i The values of 6 bits.
+ */
+static inline __m128i SplitBlocks(__m128i input)
+{
+    input = _mm_shuffle_epi8(input, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    __m128i high = _mm_mulhi_epu16(_mm_and_si128(input, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+    __m128i low = _mm_mullo_epi16(_mm_and_si128(input, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+
+    return _mm_or_si128(high, low);
+}
+
+/**
+ * @brief Translates 16 values of 6 bits into their characters.
+ *
+ * The character is the value plus an offset, which only depends on the range of the value.
+ *
+ * @param[in] values The values of 6 bits.
+ *
+ * @return __m128i The characters.
+ */
+static inline __m128i TranslateValues(__m128i values)
+{
+    // 0 for A-Z, 1 to 10 for 0-9, 11 for '+', 12 for '/', 13 for a-z
+    __m128i ranges = _mm_subs_epu8(values, _mm_set1_epi8(51));
+    ranges = _mm_or_si128(ranges, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), values), _mm_set1_epi8(13)));
+
+    const __m128i cOffsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+    return _mm_add_epi8(_mm_shuffle_epi8(cOffsets, ranges), values);
+}
+
+#if defined(__AVX2__)
+// Same as the 128 bit variant, in both 128 bit lanes
+static inline __m256i SplitBlocks(__m256i input)
+{
+    input = _mm256_shuffle_epi8(input, _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                                        1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    __m256i high = _mm256_mulhi_epu16(_mm256_and_si256(input, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+    __m256i low = _mm256_mullo_epi16(_mm256_and_si256(input, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+
+    return _mm256_or_si256(high, low);
+}
+
+// Same as the 128 bit variant, in both 128 bit lanes
+static inline __m256i TranslateValues(__m256i values)
+{
+    __m256i ranges = _mm256_subs_epu8(values, _mm256_set1_epi8(51));
+    ranges = _mm256_or_si256(ranges, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), values), _mm256_set1_epi8(13)));
+
+    const __m256i cOffsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+                                              'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+    return _mm256_add_epi8(_mm256_shuffle_epi8(cOffsets, ranges), values);
+}
+#endif // defined(__AVX2__)
+#endif // defined(__AVX2__) || defined(__SSSE3__)
+
+size_t LogBase64::EncodeBlocks(const uint8_t* pInput, size_t length, char* pOutput)
+{
+    size_t encodedLength = 0;
+
+#if defined(__AVX2__)
+    // 24 bytes per iteration, read as two overlapping 16 byte loads
+    while ((length - encodedLength) >= 28)
+    {
+        __m256i input = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pInput + encodedLength))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(pInput + encodedLength + 12)), 1);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pOutput), TranslateValues(SplitBlocks(input)));
+        pOutput += 32;
+        encodedLength += 24;
+    }
+#endif
+#if defined(__AVX2__) || defined(__SSSE3__)
+    // 12 bytes per iteration, the 4 bytes after them are read but not encoded
+    while ((length - encodedLength) >= 16)
+    {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pInput + encodedLength));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pOutput), TranslateValues(SplitBlocks(input)));
+        pOutput += 16;
+        encodedLength += 12;
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    // 48 bytes per iteration, deinterleaved into the first, second and third bytes of the blocks
+    const uint8x16x4_t cTable = { { vld1q_u8(reinterpret_cast<const uint8_t*>(&cBase64Table[0])),
+                                    vld1q_u8(reinterpret_cast<const uint8_t*>(&cBase64Table[16])),
+                                    vld1q_u8(reinterpret_cast<const uint8_t*>(&cBase64Table[32])),
+                                    vld1q_u8(reinterpret_cast<const uint8_t*>(&cBase64Table[48])) } };
+    const uint8x16_t cMask = vdupq_n_u8(0x3f);
+
+    while ((length - encodedLength) >= 48)
+    {
+        uint8x16x3_t input = vld3q_u8(pInput + encodedLength);
+        uint8x16x4_t output;
+
+        output.val[0] = vqtbl4q_u8(cTable, vshrq_n_u8(input.val[0], 2));
+        output.val[1] = vqtbl4q_u8(cTable, vandq_u8(vorrq_u8(vshlq_n_u8(input.val[0], 4), vshrq_n_u8(input.val[1], 4)), cMask));
+        output.val[2] = vqtbl4q_u8(cTable, vandq_u8(vorrq_u8(vshlq_n_u8(input.val[1], 2), vshrq_n_u8(input.val[2], 6)), cMask));
+        output.val[3] = vqtbl4q_u8(cTable, vandq_u8(input.val[2], cMask));
+
+        vst4q_u8(reinterpret_cast<uint8_t*>(pOutput), output);
+        pOutput += 64;
+        encodedLength += 48;
+    }
+#endif
+
+    // The remaining blocks, or all of them without SIMD
+    while ((length - encodedLength) >= 3)
+    {
+        const uint8_t* pBlock = pInput + encodedLength;
+        uint32_t block = (static_cast<uint32_t>(pBlock[0]) << 16) | (static_cast<uint32_t>(pBlock[1]) << 8) | pBlock[2];
+
+        pOutput[0] = cBase64Table[block >> 18];
+        pOutput[1] = cBase64Table[(block >> 12) & 0x3f];
+        pOutput[2] = cBase64Table[(block >> 6) & 0x3f];
+        pOutput[3] = cBase64Table[block & 0x3f];
+        pOutput += 4;
+        encodedLength += 3;
+    }
+
+    return encodedLength;
+}
+
+// ----------------------------------------------------------------------------
+// Public functions
+// ----------------------------------------------------------------------------
+
+size_t LogBase64::Encode(const LogSpan_t* pSegments, size_t segmentCount, char* pOutput, size_t size)
+{
+    ASSERT(pSegments != nullptr);
+    ASSERT(pOutput != nullptr);
+
+    size_t length = 0;
+    for (size_t i = 0; i < segmentCount; ++i)
+    {
+        length += pSegments[i].length;
+    }
+
+    if (LOG_BASE64_ENCODED_LENGTH(length) > size)
+    {
+        return 0;
+    }
+
+    char* pNext = pOutput;
+    *pNext++ = cPrefix;
+
+    // Bytes of a block which continues in the next segment
+    uint8_t carry[3];
+    size_t carryLength = 0;
+
+    for (size_t i = 0; i < segmentCount; ++i)
+    {
+        const uint8_t* pData = pSegments[i].pData;
+        size_t remaining = pSegments[i].length;
+
+        // Complete the block started at the end of the previous segment
+        while ((carryLength > 0) && (carryLength < 3) && (remaining > 0))
+        {
+            carry[carryLength++] = *pData++;
+            --remaining;
+        }
+        if (carryLength == 3)
+        {
+            EncodeBlocks(carry, 3, pNext);
+            pNext += 4;
+            carryLength = 0;
+        }
+
+        size_t encodedLength = EncodeBlocks(pData, remaining, pNext);
+        pNext += (encodedLength / 3) * 4;
+
+        // Less than a block is left, unless the segment ended before the carried block was complete
+        memcpy(&carry[carryLength], pData + encodedLength, remaining - encodedLength);
+        carryLength += remaining - encodedLength;
+    }
+
+    // Pad the last block
+    if (carryLength == 1)
+    {
+        *pNext++ = cBase64Table[carry[0] >> 2];
+        *pNext++ = cBase64Table[(carry[0] & 0x03) << 4];
+        *pNext++ = '=';
+        *pNext++ = '=';
+    }
+    else if (carryLength == 2)
+    {
+        *pNext++ = cBase64Table[carry[0] >> 2];
+        *pNext++ = cBase64Table[((carry[0] & 0x03) << 4) | (carry[1] >> 4)];
+        *pNext++ = cBase64Table[(carry[1] & 0x0f) << 2];
+        *pNext++ = '=';
+    }
+
+    return pNext - pOutput;
+}
+
+void LogBase64::EncodeBatch(const LogRecord_t* pRecords, size_t recordCount, LogRecord_t* pEncodedRecords,
+                            char (*pMessages)[cMessageSize])
+{
+    ASSERT(pRecords != nullptr);
+    ASSERT(pEncodedRecords != nullptr);
+    ASSERT(pMessages != nullptr);
+
+    for (size_t i = 0; i < recordCount; ++i)
+    {
+        pEncodedRecords[i] = pRecords[i];
+
+        size_t encodedLength = Encode(pRecords[i].segments, pRecords[i].segmentCount, pMessages[i], cMessageSize);
+        if (encodedLength > 0)
+        {
+            pEncodedRecords[i].segments[0] = { .pData = reinterpret_cast<const uint8_t*>(pMessages[i]), .length = encodedLength };
+            pEncodedRecords[i].segmentCount = 1;
+        }
+    }
+}
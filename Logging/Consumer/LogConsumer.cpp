@@ -13,6 +13,18 @@
 #if CONFIG_COMMONS_LOGGING_DEFERRED
     #include "LogQueue.hpp"
 #endif
+#if CONFIG_COMMONS_LOGGING_STATS
+    #include "LogOs.hpp"
+#endif
+
+#include <errno.h>
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+// Number of log levels held by the level mask, one bit each
+#define LOG_CONSUMER_LEVEL_COUNT    (32)
 
 // ----------------------------------------------------------------------------
 // Variable definitions
@@ -21,6 +33,32 @@
 // List of registered consumers
 LogToOutput* LogConsumer::mConsumers[CONFIG_COMMONS_LOGGING_MAX_CONSUMERS];
 
+// Minimum log level of each registered consumer, all levels by default
+std::atomic<uint8_t> LogConsumer::mMinLevels[CONFIG_COMMONS_LOGGING_MAX_CONSUMERS];
+
+#if CONFIG_COMMONS_LOGGING_STATS
+// Time spent by each registered consumer in ProcessLogBatch()
+std::atomic<uint64_t> LogConsumer::mTotalTimesUs[CONFIG_COMMONS_LOGGING_MAX_CONSUMERS];
+std::atomic<uint32_t> LogConsumer::mTimeHistograms[CONFIG_COMMONS_LOGGING_MAX_CONSUMERS][LOG_STATS_HISTOGRAM_BUCKET_COUNT];
+#endif
+
+#if CONFIG_COMMONS_LOGGING_BASE64_ENCODING && CONFIG_COMMONS_LOGGING_DEFERRED
+// Batch encoded for the consumers which output Base64, per read cursor
+LogRecord_t LogConsumer::mBase64Records[LOG_CURSOR_COUNT][CONFIG_COMMONS_LOGGING_BATCH_SIZE];
+char LogConsumer::mBase64Messages[LOG_CURSOR_COUNT][CONFIG_COMMONS_LOGGING_BATCH_SIZE][LogBase64::cMessageSize];
+#endif
+
+#if CONFIG_COMMONS_LOGGING_FRAMING
+#if CONFIG_COMMONS_LOGGING_DEFERRED
+// Batch framed for the consumers which output frames, per read cursor
+LogRecord_t LogConsumer::mFramedRecords[LOG_CURSOR_COUNT][CONFIG_COMMONS_LOGGING_BATCH_SIZE];
+uint8_t LogConsumer::mFrames[LOG_CURSOR_COUNT][CONFIG_COMMONS_LOGGING_BATCH_SIZE][LogFrame::cFrameSize];
+#else
+// Sequence number of the next framed log message, there is no log queue to number them in immediate mode
+std::atomic<uint32_t> LogConsumer::mSequenceNumber;
+#endif
+#endif
+
 // ----------------------------------------------------------------------------
 // Public functions
 // ----------------------------------------------------------------------------
@@ -37,17 +75,314 @@ void LogConsumer::RegisterConsumer(LogToOutput &consumer)
     }
 }
 
-void LogConsumer::SendLogMessage(const uint8_t* pMessage, size_t length, int level)
+int LogConsumer::SetConsumerLevel(uint8_t id, int level)
+{
+    // The minimum level must have a bit in the level mask
+    if ((level < 0) || (level >= LOG_CONSUMER_LEVEL_COUNT))
+    {
+        return -EINVAL;
+    }
+
+    for (size_t i = 0; i < CONFIG_COMMONS_LOGGING_MAX_CONSUMERS; ++i)
+    {
+        if ((mConsumers[i] != nullptr) && (mConsumers[i]->GetId() == id))
+        {
+            mMinLevels[i].store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+            return 0;
+        }
+    }
+
+    return -ENOENT;
+}
+
+uint32_t LogConsumer::GetLevelMask()
 {
-    UNUSED(level);
+    uint32_t levelMask = 0;
+    bool registered = false;
 
-    // Send the log message to all registered consumers
+    for (size_t i = 0; i < CONFIG_COMMONS_LOGGING_MAX_CONSUMERS; ++i)
+    {
+        if (mConsumers[i] != nullptr)
+        {
+            // All the levels from the minimum level of the consumer are wanted
+            levelMask |= ~((1U << mMinLevels[i].load(std::memory_order_relaxed)) - 1);
+            registered = true;
+        }
+    }
+
+    return registered ? levelMask : UINT32_MAX;
+}
+
+void LogConsumer::SendLogMessage(const uint8_t* pMessage, size_t length, int level, const LogSource_t* pSource)
+{
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX || CONFIG_COMMONS_LOGGING_TIMESTAMP || CONFIG_COMMONS_LOGGING_FRAMING
+    // The consumers render the prefix and the time from the metadata of the record, the frames carry it
+    LogRecord_t record = { .segments       = { { .pData = pMessage, .length = length } },
+                           .segmentCount   = 1,
+                           .level          = level,
+    #if CONFIG_COMMONS_LOGGING_FRAMING && !CONFIG_COMMONS_LOGGING_DEFERRED
+                           .sequenceNumber = mSequenceNumber.fetch_add(1, std::memory_order_relaxed),
+    #else
+                           .sequenceNumber = 0,
+    #endif
+    #if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+                           .source         = (pSource != nullptr) ? *pSource : LogSource_t{},
+    #endif
+    #if CONFIG_COMMONS_LOGGING_TIMESTAMP
+                           .timestamp      = LogTimestamp_Get(),
+    #endif
+                         };
+#endif
+#if !CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+    UNUSED(pSource);
+#endif
+#if CONFIG_COMMONS_LOGGING_BASE64_ENCODING
+    // Encoded once, for the first consumer which outputs Base64
+    char base64Message[LogBase64::cMessageSize];
+    size_t base64Length = SIZE_MAX;
+#endif
+#if CONFIG_COMMONS_LOGGING_FRAMING
+    // Framed once, for the first consumer which outputs frames
+    uint8_t frame[LogFrame::cFrameSize];
+    size_t frameLength = SIZE_MAX;
+#endif
+
+    // Send the log message to all registered consumers which want its level
     for (size_t i = 0; i < CONFIG_COMMONS_LOGGING_MAX_CONSUMERS; ++i)
     {
         LogToOutput* pConsumer = mConsumers[i];
-        if (pConsumer != nullptr)
+        if ((pConsumer != nullptr) && (level >= mMinLevels[i].load(std::memory_order_relaxed)))
         {
-            pConsumer->ProcessLogMessage(pMessage, length);
+            const uint8_t* pConsumerMessage = pMessage;
+            size_t consumerLength = length;
+
+#if CONFIG_COMMONS_LOGGING_TOKENIZED
+            // A log message which cannot be Base64 encoded is sent as is, one which cannot be framed is dropped
+            switch (pConsumer->GetOutputFormat())
+            {
+    #if CONFIG_COMMONS_LOGGING_BASE64_ENCODING
+                case LOG_OUTPUT_FORMAT_BASE64:
+                    if (base64Length == SIZE_MAX)
+                    {
+                        LogSpan_t segment = { .pData = pMessage, .length = length };
+                        base64Length = LogBase64::Encode(&segment, 1, base64Message, sizeof(base64Message));
+                    }
+
+                    if (base64Length > 0)
+                    {
+                        pConsumerMessage = reinterpret_cast<const uint8_t*>(base64Message);
+                        consumerLength = base64Length;
+                    }
+                    break;
+    #endif
+    #if CONFIG_COMMONS_LOGGING_FRAMING
+                case LOG_OUTPUT_FORMAT_FRAMED:
+                    if (frameLength == SIZE_MAX)
+                    {
+                        // The record may already point to the message of another consumer
+                        LogRecord_t frameRecord = record;
+                        frameRecord.segments[0] = { .pData = pMessage, .length = length };
+                        frameLength = LogFrame::Encode(frameRecord, frame, sizeof(frame));
+                        if (frameLength == 0)
+                        {
+                            LogFrame::CountDroppedLog();
+                        }
+                    }
+
+                    if (frameLength == 0)
+                    {
+                        continue;
+                    }
+
+                    pConsumerMessage = frame;
+                    consumerLength = frameLength;
+                    break;
+    #endif
+                default:
+                    break;
+            }
+#endif
+
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX || CONFIG_COMMONS_LOGGING_TIMESTAMP
+            record.segments[0] = { .pData = pConsumerMessage, .length = consumerLength };
+            pConsumer->ProcessLogBatch(&record, 1);
+#else
+            pConsumer->ProcessLogMessage(pConsumerMessage, consumerLength);
+#endif
         }
     }
 }
+
+size_t LogConsumer::GetConsumerCount()
+{
+    size_t consumerCount = 0;
+
+    // The slots are indexed by the callers, so the count reaches the last registered consumer
+    for (size_t i = 0; i < CONFIG_COMMONS_LOGGING_MAX_CONSUMERS; ++i)
+    {
+        if (mConsumers[i] != nullptr)
+        {
+            consumerCount = i + 1;
+        }
+    }
+
+    return consumerCount;
+}
+
+#if CONFIG_COMMONS_LOGGING_DEFERRED
+void LogConsumer::SendLogBatch(const LogRecord_t* pRecords, size_t recordCount)
+{
+    SendLogBatch(pRecords, recordCount, 0, CONFIG_COMMONS_LOGGING_MAX_CONSUMERS);
+}
+
+#if CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS
+void LogConsumer::SendLogBatch(size_t index, const LogRecord_t* pRecords, size_t recordCount)
+{
+    if (index < CONFIG_COMMONS_LOGGING_MAX_CONSUMERS)
+    {
+        SendLogBatch(pRecords, recordCount, index, index + 1);
+    }
+}
+#endif
+#endif // CONFIG_COMMONS_LOGGING_DEFERRED
+
+#if CONFIG_COMMONS_LOGGING_STATS
+void LogConsumer::GetConsumerStats(LogConsumerStats_t (&stats)[CONFIG_COMMONS_LOGGING_MAX_CONSUMERS])
+{
+    for (size_t i = 0; i < CONFIG_COMMONS_LOGGING_MAX_CONSUMERS; ++i)
+    {
+        stats[i] = {};
+        if (mConsumers[i] == nullptr)
+        {
+            continue;
+        }
+
+        stats[i].id = mConsumers[i]->GetId();
+        stats[i].registered = true;
+        stats[i].totalTimeUs = mTotalTimesUs[i].load(std::memory_order_relaxed);
+        for (size_t j = 0; j < LOG_STATS_HISTOGRAM_BUCKET_COUNT; ++j)
+        {
+            stats[i].timeHistogram[j] = mTimeHistograms[i][j].load(std::memory_order_relaxed);
+        }
+    }
+}
+#endif // CONFIG_COMMONS_LOGGING_STATS
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+#if CONFIG_COMMONS_LOGGING_DEFERRED
+void LogConsumer::SendLogBatch(const LogRecord_t* pRecords, size_t recordCount, size_t firstIndex, size_t endIndex)
+{
+    // Find the lowest log level in the batch
+    int lowestLevel = INT32_MAX;
+    for (size_t i = 0; i < recordCount; ++i)
+    {
+        lowestLevel = (pRecords[i].level < lowestLevel) ? pRecords[i].level : lowestLevel;
+    }
+
+#if CONFIG_COMMONS_LOGGING_BASE64_ENCODING || CONFIG_COMMONS_LOGGING_FRAMING
+    // Encoded once per format, for the first consumer which outputs it. Only one context sends the batches
+    // of a read cursor at a time, and with a cursor per consumer the slot is the cursor.
+    size_t cursor = firstIndex % LOG_CURSOR_COUNT;
+#endif
+#if CONFIG_COMMONS_LOGGING_BASE64_ENCODING
+    const LogRecord_t* pBase64Records = nullptr;
+#endif
+#if CONFIG_COMMONS_LOGGING_FRAMING
+    const LogRecord_t* pFramedRecords = nullptr;
+    size_t framedRecordCount = 0;
+#endif
+
+    // Send the log messages to the registered consumers which want their level
+    for (size_t i = firstIndex; i < endIndex; ++i)
+    {
+        LogToOutput* pConsumer = mConsumers[i];
+        if (pConsumer == nullptr)
+        {
+            continue;
+        }
+
+        const LogRecord_t* pConsumerRecords = pRecords;
+        size_t consumerRecordCount = recordCount;
+#if CONFIG_COMMONS_LOGGING_TOKENIZED
+        switch (pConsumer->GetOutputFormat())
+        {
+    #if CONFIG_COMMONS_LOGGING_BASE64_ENCODING
+            case LOG_OUTPUT_FORMAT_BASE64:
+                if (pBase64Records == nullptr)
+                {
+                    LogBase64::EncodeBatch(pRecords, recordCount, mBase64Records[cursor], mBase64Messages[cursor]);
+                    pBase64Records = mBase64Records[cursor];
+                }
+
+                pConsumerRecords = pBase64Records;
+                break;
+    #endif
+    #if CONFIG_COMMONS_LOGGING_FRAMING
+            case LOG_OUTPUT_FORMAT_FRAMED:
+                if (pFramedRecords == nullptr)
+                {
+                    // The log messages which cannot be framed are dropped
+                    framedRecordCount = LogFrame::EncodeBatch(pRecords, recordCount, mFramedRecords[cursor], mFrames[cursor]);
+                    pFramedRecords = mFramedRecords[cursor];
+                }
+
+                pConsumerRecords = pFramedRecords;
+                consumerRecordCount = framedRecordCount;
+                break;
+    #endif
+            default:
+                break;
+        }
+#endif
+
+        int minLevel = mMinLevels[i].load(std::memory_order_relaxed);
+        if ((lowestLevel >= minLevel) && (consumerRecordCount > 0))
+        {
+            // The consumer wants the whole batch
+            ProcessLogBatch(i, pConsumerRecords, consumerRecordCount);
+            continue;
+        }
+
+        LogRecord_t filteredRecords[CONFIG_COMMONS_LOGGING_BATCH_SIZE];
+        size_t filteredRecordCount = 0;
+        for (size_t j = 0; (j < consumerRecordCount) && (filteredRecordCount < CONFIG_COMMONS_LOGGING_BATCH_SIZE); ++j)
+        {
+            if (pConsumerRecords[j].level >= minLevel)
+            {
+                filteredRecords[filteredRecordCount++] = pConsumerRecords[j];
+            }
+        }
+
+        if (filteredRecordCount > 0)
+        {
+            ProcessLogBatch(i, filteredRecords, filteredRecordCount);
+        }
+    }
+}
+
+void LogConsumer::ProcessLogBatch(size_t index, const LogRecord_t* pRecords, size_t recordCount)
+{
+#if CONFIG_COMMONS_LOGGING_STATS
+    uint32_t startCycles = LogOs::GetCycleCount();
+#endif
+
+    mConsumers[index]->ProcessLogBatch(pRecords, recordCount);
+
+#if CONFIG_COMMONS_LOGGING_STATS
+    uint32_t durationUs = LogOs::CyclesToUs(LogOs::GetCycleCount() - startCycles);
+
+    // Bucket i holds the durations below 2^i us, so it is the number of significant bits of the duration
+    size_t bucket = 0;
+    while ((bucket < (LOG_STATS_HISTOGRAM_BUCKET_COUNT - 1)) && ((durationUs >> bucket) != 0))
+    {
+        ++bucket;
+    }
+
+    mTotalTimesUs[index].fetch_add(durationUs, std::memory_order_relaxed);
+    mTimeHistograms[index][bucket].fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+#endif // CONFIG_COMMONS_LOGGING_DEFERRED
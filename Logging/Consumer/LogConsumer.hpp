@@ -11,6 +11,17 @@
 // ----------------------------------------------------------------------------
 
 #include "LogToOutput.hpp"
+#if CONFIG_COMMONS_LOGGING_BASE64_ENCODING
+    #include "LogBase64.hpp"
+#endif
+#if CONFIG_COMMONS_LOGGING_FRAMING
+    #include "LogFrame.hpp"
+#endif
+#if CONFIG_COMMONS_LOGGING_STATS
+    #include "LogStats.hpp"
+#endif
+
+#include <atomic>
 
 // ----------------------------------------------------------------------------
 // Class definition
@@ -27,6 +38,29 @@ public:
      */
     static void RegisterConsumer(LogToOutput &consumer);
 
+    /**
+     * @brief Set the minimum log level of a registered consumer.
+     *
+     * Log messages below this level are not sent to the consumer.
+     *
+     * @param[in] id Unique identifier of the consumer.
+     * @param[in] level Minimum log level.
+     *
+     * @return int Returns 0 on success, -EINVAL if the level is not between 0 and 31,
+     *             or -ENOENT if no consumer is registered with the identifier.
+     */
+    static int SetConsumerLevel(uint8_t id, int level);
+
+    /**
+     * @brief Get the mask of the log levels wanted by at least one registered consumer.
+     *
+     * While no consumer is registered, all the log levels are wanted, so that
+     * the queued log messages can be sent once the consumers are registered.
+     *
+     * @return uint32_t Mask with the bit of each wanted log level set.
+     */
+    static uint32_t GetLevelMask();
+
     /**
      * @brief Send log message to all the registered consumers.
      *
@@ -35,10 +69,87 @@ public:
      * @param[in] pMessage Pointer to the log message.
      * @param[in] length Length of the log message.
      * @param[in] level Log level of the message.
+     * @param[in] pSource Origin of the message, or nullptr if unknown.
      */
-    static void SendLogMessage(const uint8_t* pMessage, size_t length, int level);
+    static void SendLogMessage(const uint8_t* pMessage, size_t length, int level, const LogSource_t* pSource = nullptr);
+
+    /**
+     * @brief Get the number of consumer slots in use.
+     *
+     * The slots are counted up to the last registered consumer, so that every registered
+     * consumer has its slot below the count.
+     *
+     * @return size_t Number of consumer slots in use.
+     */
+    static size_t GetConsumerCount();
+
+#if CONFIG_COMMONS_LOGGING_DEFERRED
+    /**
+     * @brief Send a batch of log messages to all the registered consumers.
+     *
+     * @param[in] pRecords Pointer to the log messages.
+     * @param[in] recordCount Number of log messages.
+     */
+    static void SendLogBatch(const LogRecord_t* pRecords, size_t recordCount);
+
+#if CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS
+    /**
+     * @brief Send a batch of log messages to a single registered consumer.
+     *
+     * @param[in] index Slot of the consumer, in the order of registration.
+     * @param[in] pRecords Pointer to the log messages.
+     * @param[in] recordCount Number of log messages.
+     */
+    static void SendLogBatch(size_t index, const LogRecord_t* pRecords, size_t recordCount);
+#endif
+#endif
+
+#if CONFIG_COMMONS_LOGGING_STATS
+    /**
+     * @brief Get the time spent by every consumer slot in ProcessLogBatch() since the start.
+     *
+     * @param[out] stats The statistics of every consumer slot, in the order of registration.
+     */
+    static void GetConsumerStats(LogConsumerStats_t (&stats)[CONFIG_COMMONS_LOGGING_MAX_CONSUMERS]);
+#endif
 
 private:
 
+#if CONFIG_COMMONS_LOGGING_DEFERRED
+    /**
+     * @brief Send a batch of log messages to the registered consumers of a range of slots.
+     *
+     * @param[in] pRecords Pointer to the log messages.
+     * @param[in] recordCount Number of log messages.
+     * @param[in] firstIndex First slot to send to.
+     * @param[in] endIndex Slot after the last one to send to.
+     */
+    static void SendLogBatch(const LogRecord_t* pRecords, size_t recordCount, size_t firstIndex, size_t endIndex);
+
+    /**
+     * @brief Hand a batch of log messages over to a registered consumer, and measure the time it takes.
+     *
+     * @param[in] index Slot of the consumer.
+     * @param[in] pRecords Pointer to the log messages.
+     * @param[in] recordCount Number of log messages.
+     */
+    static void ProcessLogBatch(size_t index, const LogRecord_t* pRecords, size_t recordCount);
+#endif
+
     static LogToOutput* mConsumers[CONFIG_COMMONS_LOGGING_MAX_CONSUMERS];           // Array of registered consumers
+    static std::atomic<uint8_t> mMinLevels[CONFIG_COMMONS_LOGGING_MAX_CONSUMERS];   // Minimum log level of each registered consumer
+#if CONFIG_COMMONS_LOGGING_BASE64_ENCODING && CONFIG_COMMONS_LOGGING_DEFERRED
+    static LogRecord_t mBase64Records[LOG_CURSOR_COUNT][CONFIG_COMMONS_LOGGING_BATCH_SIZE];    // Encoded batch of each read cursor
+    static char mBase64Messages[LOG_CURSOR_COUNT][CONFIG_COMMONS_LOGGING_BATCH_SIZE][LogBase64::cMessageSize]; // Encoded messages of the batch
+#endif
+#if CONFIG_COMMONS_LOGGING_FRAMING && CONFIG_COMMONS_LOGGING_DEFERRED
+    static LogRecord_t mFramedRecords[LOG_CURSOR_COUNT][CONFIG_COMMONS_LOGGING_BATCH_SIZE];      // Framed batch of each read cursor
+    static uint8_t mFrames[LOG_CURSOR_COUNT][CONFIG_COMMONS_LOGGING_BATCH_SIZE][LogFrame::cFrameSize]; // Frames of the batch
+#elif CONFIG_COMMONS_LOGGING_FRAMING
+    static std::atomic<uint32_t> mSequenceNumber;   // Sequence number of the next framed log message
+#endif
+#if CONFIG_COMMONS_LOGGING_STATS
+    static std::atomic<uint64_t> mTotalTimesUs[CONFIG_COMMONS_LOGGING_MAX_CONSUMERS];  // Time spent by each consumer, in microseconds
+    static std::atomic<uint32_t> mTimeHistograms[CONFIG_COMMONS_LOGGING_MAX_CONSUMERS][LOG_STATS_HISTOGRAM_BUCKET_COUNT]; // Calls of each consumer per duration
+#endif
 };
@@ -0,0 +1,220 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "Assert.h"
+#include "LogFrame.hpp"
+
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+// Largest code byte, it starts a block of 254 bytes without a zero byte after it
+#define LOG_COBS_MAX_CODE   0xFF
+
+// Size of the payload before the log message
+#define LOG_FRAME_MAX_HEADER_SIZE   (1 + LOG_FRAME_MAX_SEQUENCE_NUMBER_SIZE + LOG_FRAME_MAX_TIMESTAMP_SIZE)
+
+// ----------------------------------------------------------------------------
+// Datatype definitions
+// ----------------------------------------------------------------------------
+
+// State of the COBS encoding of a payload, written straight into the frame
+typedef struct
+{
+    uint8_t*    pOutput;        // Pointer to the frame
+    size_t      length;         // Number of bytes of the frame written so far
+    size_t      codeIndex;      // Position of the code byte of the current block
+    uint8_t     code;           // Number of bytes of the current block, code byte included
+} LogCobsEncoder_t;
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Encodes a value as a base 128 varint.
+ *
+ * @param[in] value The value to encode.
+ * @param[out] pOutput Pointer to the buffer receiving the varint, large enough for the value.
+ *
+ * @return size_t Number of bytes of the varint.
+ */
+static size_t WriteVarint(uint64_t value, uint8_t* pOutput)
+{
+    size_t length = 0;
+
+    while (value >= 0x80)
+    {
+        pOutput[length++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+
+    pOutput[length++] = static_cast<uint8_t>(value);
+    return length;
+}
+
+/**
+ * @brief Ends the current COBS block, and starts the next one.
+ *
+ * @param[in,out] encoder The state of the encoding.
+ */
+static inline void EndBlock(LogCobsEncoder_t& encoder)
+{
+    encoder.pOutput[encoder.codeIndex] = encoder.code;
+    encoder.codeIndex = encoder.length++;
+    encoder.code = 1;
+}
+
+/**
+ * @brief COBS encodes more bytes of the payload.
+ *
+ * The runs of non zero bytes are copied at once, the frame must be large enough for the whole payload.
+ *
+ * @param[in,out] encoder The state of the encoding.
+ * @param[in] pData Pointer to the bytes.
+ * @param[in] length Number of bytes.
+ */
+static void EncodeBytes(LogCobsEncoder_t& encoder, const uint8_t* pData, size_t length)
+{
+    while (length > 0)
+    {
+        size_t runLength = LOG_COBS_MAX_CODE - encoder.code;
+        runLength = (length < runLength) ? length : runLength;
+
+        const uint8_t* pZero = static_cast<const uint8_t*>(memchr(pData, 0, runLength));
+        if (pZero != nullptr)
+        {
+            runLength = static_cast<size_t>(pZero - pData);
+        }
+
+        memcpy(&encoder.pOutput[encoder.length], pData, runLength);
+        encoder.length += runLength;
+        encoder.code = static_cast<uint8_t>(encoder.code + runLength);
+        pData += runLength;
+        length -= runLength;
+
+        if (pZero != nullptr)
+        {
+            // The zero byte is replaced by the code byte of the block it ends
+            EndBlock(encoder);
+            ++pData;
+            --length;
+        }
+        else if (encoder.code == LOG_COBS_MAX_CODE)
+        {
+            EndBlock(encoder);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Public functions
+// ----------------------------------------------------------------------------
+
+size_t LogFrame::Encode(const LogRecord_t& record, uint8_t* pOutput, size_t size)
+{
+    ASSERT(pOutput != nullptr);
+
+    uint8_t header[LOG_FRAME_MAX_HEADER_SIZE];
+    size_t headerLength = 0;
+
+    header[headerLength] = static_cast<uint8_t>(record.level & LOG_FRAME_LEVEL_MASK);
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    header[headerLength] |= LOG_FRAME_TIMESTAMP_FLAG;
+#endif
+#if CONFIG_COMMONS_LOGGING_FRAMING_CRC
+    header[headerLength] |= LOG_FRAME_CRC_FLAG;
+#endif
+    ++headerLength;
+
+    headerLength += WriteVarint(record.sequenceNumber, &header[headerLength]);
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    headerLength += WriteVarint(record.timestamp, &header[headerLength]);
+#endif
+
+    size_t payloadLength = headerLength;
+    for (size_t i = 0; i < record.segmentCount; ++i)
+    {
+        payloadLength += record.segments[i].length;
+    }
+#if CONFIG_COMMONS_LOGGING_FRAMING_CRC
+    payloadLength += LOG_FRAME_CRC_SIZE;
+#endif
+
+    // The size of the frame is checked once, so that the encoding does not check every byte
+    if (LOG_FRAME_ENCODED_SIZE(payloadLength) > size)
+    {
+        return 0;
+    }
+
+    LogCobsEncoder_t encoder = { .pOutput = pOutput, .length = 1, .codeIndex = 0, .code = 1 };
+
+    EncodeBytes(encoder, header, headerLength);
+    for (size_t i = 0; i < record.segmentCount; ++i)
+    {
+        EncodeBytes(encoder, record.segments[i].pData, record.segments[i].length);
+    }
+
+#if CONFIG_COMMONS_LOGGING_FRAMING_CRC
+    uint16_t crc = LogFrame_UpdateCrc(LOG_FRAME_CRC_INITIAL_VALUE, header, headerLength);
+    for (size_t i = 0; i < record.segmentCount; ++i)
+    {
+        crc = LogFrame_UpdateCrc(crc, record.segments[i].pData, record.segments[i].length);
+    }
+
+    uint8_t crcBytes[LOG_FRAME_CRC_SIZE] = { static_cast<uint8_t>(crc), static_cast<uint8_t>(crc >> 8) };
+    EncodeBytes(encoder, crcBytes, sizeof(crcBytes));
+#endif
+
+    pOutput[encoder.codeIndex] = encoder.code;
+    pOutput[encoder.length++] = LOG_FRAME_DELIMITER;
+
+    return encoder.length;
+}
+
+size_t LogFrame::EncodeBatch(const LogRecord_t* pRecords, size_t recordCount, LogRecord_t* pFramedRecords,
+                             uint8_t (*pFrames)[cFrameSize])
+{
+    ASSERT(pRecords != nullptr);
+    ASSERT(pFramedRecords != nullptr);
+    ASSERT(pFrames != nullptr);
+
+    size_t framedRecordCount = 0;
+
+    for (size_t i = 0; i < recordCount; ++i)
+    {
+        size_t frameLength = Encode(pRecords[i], pFrames[framedRecordCount], cFrameSize);
+        if (frameLength == 0)
+        {
+            // The raw log message would not be understood by the decoder of the frames
+            CountDroppedLog();
+            continue;
+        }
+
+        pFramedRecords[framedRecordCount] = pRecords[i];
+        pFramedRecords[framedRecordCount].segments[0] = { .pData = pFrames[framedRecordCount], .length = frameLength };
+        pFramedRecords[framedRecordCount].segmentCount = 1;
+        ++framedRecordCount;
+    }
+
+    return framedRecordCount;
+}
+
+void LogFrame::CountDroppedLog()
+{
+    mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t LogFrame::GetDroppedCount()
+{
+    return mDroppedCount.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,284 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "Assert.h"
+#include "LogToFile.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+// Number of bytes written between two msync() calls, so that the write back starts early without a system call per log message
+#define LOG_FILE_SYNC_SIZE          (256 * 1024)
+
+// Longest path of a segment file, index included
+#define LOG_FILE_MAX_PATH_LENGTH    (4096)
+
+// The text log messages are written one per line
+#define LOG_FILE_LINE_ENDING        '\n'
+
+// Minimum time between two attempts to open a segment file, while the log messages are dropped
+#define LOG_FILE_RETRY_INTERVAL_MS  (1000)
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Gets the time of the monotonic clock, to rate limit the attempts to open a segment file.
+ *
+ * @return uint64_t Time in milliseconds.
+ */
+static uint64_t GetTimeMs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (static_cast<uint64_t>(now.tv_sec) * 1000U) + (static_cast<uint64_t>(now.tv_nsec) / 1000000U);
+}
+
+// ----------------------------------------------------------------------------
+// Public functions
+// ----------------------------------------------------------------------------
+
+LogToFile::LogToFile(const char* pPath, size_t segmentSize, size_t segmentCount) :
+    mPath(pPath),
+    mSegmentSize(segmentSize),
+    mSegmentCount(segmentCount),
+    mPageSize(static_cast<size_t>(sysconf(_SC_PAGESIZE)))
+{
+    ASSERT(pPath != nullptr);
+
+    // A segment file holds at least a full log message
+    if (mSegmentSize < mPageSize)
+    {
+        mSegmentSize = mPageSize;
+    }
+    mSegmentSize = ((mSegmentSize + mPageSize - 1) / mPageSize) * mPageSize;
+}
+
+LogToFile::~LogToFile()
+{
+    Close();
+}
+
+void LogToFile::Initialize()
+{
+    mOpenTimeMs = GetTimeMs();
+    mLastError.store(OpenSegment(), std::memory_order_relaxed);
+}
+
+void LogToFile::ProcessLogMessage(const uint8_t* pMessage, size_t length)
+{
+    ASSERT(pMessage != nullptr);
+
+    LogSpan_t segment = { .pData = pMessage, .length = length };
+    Write(&segment, 1);
+}
+
+void LogToFile::ProcessLogMessage(const LogSpan_t* pSegments, size_t segmentCount)
+{
+    ASSERT(pSegments != nullptr);
+
+    Write(pSegments, segmentCount);
+}
+
+#if CONFIG_COMMONS_LOGGING_TOKENIZED
+LogOutputFormat_t LogToFile::GetOutputFormat() const
+{
+#if CONFIG_COMMONS_LOGGING_FRAMING
+    // The frames carry the metadata and are more compact than Base64
+    return LOG_OUTPUT_FORMAT_FRAMED;
+#else
+    return LOG_OUTPUT_FORMAT_BASE64;
+#endif
+}
+#endif
+
+void LogToFile::Close()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    CloseSegment();
+}
+
+int LogToFile::GetLastError() const
+{
+    return mLastError.load(std::memory_order_relaxed);
+}
+
+uint64_t LogToFile::GetDroppedCount() const
+{
+    return mDroppedCount.load(std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+void LogToFile::Write(const LogSpan_t* pSegments, size_t segmentCount)
+{
+    size_t length = 0;
+    for (size_t i = 0; i < segmentCount; ++i)
+    {
+        length += pSegments[i].length;
+    }
+
+    // The frames are delimited already, the text log messages end with a line ending unless the log format has one
+    bool addLineEnding = true;
+#if CONFIG_COMMONS_LOGGING_FRAMING
+    addLineEnding = false;
+#endif
+    for (size_t i = segmentCount; addLineEnding && (i > 0); --i)
+    {
+        if (pSegments[i - 1].length > 0)
+        {
+            addLineEnding = (pSegments[i - 1].pData[pSegments[i - 1].length - 1] != LOG_FILE_LINE_ENDING);
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    size_t size = length + (addLineEnding ? 1 : 0);
+    if ((mpSegment != nullptr) && (size > (mSegmentSize - mOffset)) && (mOffset > 0))
+    {
+        CloseSegment();
+        mOpenTimeMs = GetTimeMs();
+        mLastError.store(OpenSegment(), std::memory_order_relaxed);
+    }
+    else if (mpSegment == nullptr)
+    {
+        // A segment file which could not be opened, eg: for a transient lack of disk space, or which was closed
+        // is opened again by a later log message, without retrying for every log message meanwhile
+        uint64_t now = GetTimeMs();
+        if ((now - mOpenTimeMs) >= LOG_FILE_RETRY_INTERVAL_MS)
+        {
+            mOpenTimeMs = now;
+            mLastError.store(OpenSegment(), std::memory_order_relaxed);
+        }
+    }
+
+    if (mpSegment == nullptr)
+    {
+        mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // A log message larger than a whole segment file is truncated
+    uint8_t* pOutput = &mpSegment[mOffset];
+    size_t available = mSegmentSize - mOffset;
+    for (size_t i = 0; (i < segmentCount) && (available > 0); ++i)
+    {
+        size_t segmentLength = (pSegments[i].length < available) ? pSegments[i].length : available;
+        memcpy(pOutput, pSegments[i].pData, segmentLength);
+        pOutput += segmentLength;
+        available -= segmentLength;
+    }
+
+    if (addLineEnding && (available > 0))
+    {
+        *pOutput++ = LOG_FILE_LINE_ENDING;
+    }
+
+    mOffset = static_cast<size_t>(pOutput - mpSegment);
+    if ((mOffset - mSyncOffset) >= LOG_FILE_SYNC_SIZE)
+    {
+        Sync();
+    }
+}
+
+int LogToFile::OpenSegment()
+{
+    char path[LOG_FILE_MAX_PATH_LENGTH];
+
+    // Only the last segment files are kept, the oldest one is reused
+    if ((mSegmentCount > 0) && (mSegmentIndex >= mSegmentCount))
+    {
+        snprintf(path, sizeof(path), "%s.%u", mPath.c_str(), static_cast<unsigned int>(mSegmentIndex - mSegmentCount));
+        unlink(path);
+    }
+
+    // The index is only used once its segment file is opened, so that the retries do not remove the kept ones
+    snprintf(path, sizeof(path), "%s.%u", mPath.c_str(), static_cast<unsigned int>(mSegmentIndex));
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return -errno;
+    }
+
+    // The blocks are allocated upfront, so that a write to the mapping never fails for lack of disk space
+    int rc = posix_fallocate(fd, 0, static_cast<off_t>(mSegmentSize));
+    if (rc != 0)
+    {
+        close(fd);
+        unlink(path);
+        return -rc;
+    }
+
+    void* pSegment = mmap(nullptr, mSegmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (pSegment == MAP_FAILED)
+    {
+        rc = -errno;
+        close(fd);
+        unlink(path);
+        return rc;
+    }
+
+    ++mSegmentIndex;
+    mFd = fd;
+    mpSegment = static_cast<uint8_t*>(pSegment);
+    mOffset = 0;
+    mSyncOffset = 0;
+
+    return 0;
+}
+
+void LogToFile::CloseSegment()
+{
+    if (mpSegment == nullptr)
+    {
+        return;
+    }
+
+    Sync();
+    munmap(mpSegment, mSegmentSize);
+
+    // The readers only see the log messages, not the zero filled end
+    if (ftruncate(mFd, static_cast<off_t>(mOffset)) != 0)
+    {
+        mLastError.store(-errno, std::memory_order_relaxed);
+    }
+    close(mFd);
+
+    mFd = -1;
+    mpSegment = nullptr;
+}
+
+void LogToFile::Sync()
+{
+    // msync() takes a page aligned address
+    size_t start = (mSyncOffset / mPageSize) * mPageSize;
+    if (mOffset > start)
+    {
+        msync(&mpSegment[start], mOffset - start, MS_ASYNC);
+    }
+
+    mSyncOffset = mOffset;
+}
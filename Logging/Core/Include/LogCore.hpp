@@ -10,33 +10,113 @@
 
 #include "LogToOutput.hpp"
 
+#include <atomic>
+#include <cstdarg>
+
 #if CONFIG_COMMONS_LOGGING_DEFERRED
-    #include <zephyr/kernel.h>
+    #include "LogOs.hpp"
+#endif
+#if CONFIG_COMMONS_LOGGING_STATS
+    #include "LogStats.hpp"
 #endif
 
 // ----------------------------------------------------------------------------
 // Class definition
 // ----------------------------------------------------------------------------
 
+#if CONFIG_COMMONS_LOGGING_DEFERRED
+    class LogQueue;
+#endif
+
 class LogCore
 {
 public:
     /**
      * @brief Registers a consumer to receive log messages.
      *
+     * With CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS, it must be called before InitializeQueue(),
+     * which creates a read cursor and a log thread per registered consumer.
+     *
      * @param[in] id Unique identifier for the consumer.
      * @param[in] consumer Reference to the consumer that will handle log messages.
      */
     static void RegisterConsumer(uint8_t id, LogToOutput &consumer);
 
+    /**
+     * @brief Sets the minimum log level of a registered consumer. It can be changed at any time.
+     *
+     * @param[in] id Unique identifier of the consumer.
+     * @param[in] level Minimum log level of the messages sent to the consumer.
+     *
+     * @return int Returns 0 on success, -EINVAL if the level is not between 0 and 31,
+     *             or -ENOENT if no consumer is registered with the identifier.
+     */
+    static int SetConsumerLevel(uint8_t id, int level);
+
+    /**
+     * @brief Checks if at least one consumer wants log messages of the given level.
+     *
+     * Producers call it before doing any work for a log message.
+     *
+     * @param[in] level Log level of the message.
+     *
+     * @return bool Returns true if the log message must be handled, otherwise false.
+     */
+    static bool IsLevelEnabled(int level)
+    {
+        return (mLevelMask.load(std::memory_order_relaxed) & (1U << level)) != 0;
+    }
+
 #if CONFIG_COMMONS_LOGGING_DEFERRED
     /**
      * @brief Initializes the log queue and start the log thread.
      *
+     * When there are multiple log queues, the buffer is split evenly between them.
+     * With the priority lane, CONFIG_COMMONS_LOGGING_PRIORITY_LANE_PERCENT of the buffer is set aside for it first.
+     * With CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS, every registered consumer gets its own cursor and log thread,
+     * so the consumers must be registered before.
+     *
      * @param[in] pBuffer Pointer to the buffer used for the log queue.
      * @param[in] bufferSize Size of the buffer in bytes.
      */
     static void InitializeQueue(void* pBuffer, size_t bufferSize);
+
+#if CONFIG_COMMONS_LOGGING_QUEUE_PER_THREAD
+    /**
+     * @brief Assigns a dedicated log queue to the calling thread.
+     *
+     * The log messages of the thread are then queued without contention with other threads.
+     * The threads which are not registered share the first log queue.
+     *
+     * @return int Returns 0 on success, or -ENOSPC if all the dedicated log queues are already assigned.
+     */
+    static int RegisterThread();
+#endif
+
+#if CONFIG_COMMONS_LOGGING_BLOCKING
+    /**
+     * @brief Sets how long the calling thread waits for space when the log queue is full.
+     *
+     * The thread waits for the log thread to drain the log queue, before the log message is drained
+     * by the thread itself or dropped. It never waits from an ISR, a thread which is not preemptible
+     * or in panic mode. The default is CONFIG_COMMONS_LOGGING_BLOCKING_TIMEOUT_MS.
+     *
+     * @param[in] timeoutMs Maximum time to wait in milliseconds per log message, 0 to never wait.
+     */
+    static void SetBlockingTimeout(uint32_t timeoutMs);
+#endif
+
+#if CONFIG_COMMONS_LOGGING_STATS
+    /**
+     * @brief Gets the statistics of the deferred logging since the start.
+     *
+     * The counters are read one by one while the producers keep logging,
+     * so they may be slightly out of sync with each other.
+     *
+     * @param[out] stats The statistics.
+     */
+    static void GetStats(LogStats_t &stats);
+#endif
 #endif
 
     /**
@@ -50,8 +130,53 @@ public:
      * @param[in] pMessage Pointer to the log message.
      * @param[in] length Length of the log message.
      * @param[in] level Log level of the message.
+     * @param[in] pSource Origin of the message, or nullptr if unknown.
+     */
+    static void HandleLogMessage(const uint8_t* pMessage, size_t length, int level, const LogSource_t* pSource = nullptr);
+
+#if CONFIG_COMMONS_LOGGING_DEFERRED
+    /**
+     * @brief Reserves a slot in the log queue, so that the producer can write the log message in place.
+     *
+     * On success, the log message must be published with CommitLogMessage().
+     *
+     * @param[out] pSlot Pointer to the reserved slot.
+     * @param[in] maxLength Maximum length of the log message.
+     * @param[in] level Log level of the message, which selects the log queue.
+     *
+     * @return int Returns 0 on success, or -EAGAIN if the message must be sent with HandleLogMessage()
+     *             instead, which also happens when the slot cannot be reserved, eg: when it is larger
+     *             than the log queue.
+     */
+    static int ReserveLogMessage(uint8_t* &pSlot, size_t maxLength, int level);
+
+    /**
+     * @brief Publishes the log message written into the slot returned by ReserveLogMessage().
+     *
+     * @param[in] length Actual length of the log message.
+     * @param[in] level Log level of the message.
+     * @param[in] pSource Origin of the message, or nullptr if unknown.
+     */
+    static void CommitLogMessage(size_t length, int level, const LogSource_t* pSource = nullptr);
+
+#if CONFIG_COMMONS_LOGGING_DEFERRED_FORMAT
+    /**
+     * @brief Queues a log message without formatting it.
+     *
+     * The format string and the arguments are packed into the log queue, and the message
+     * is formatted by the log thread just before it is sent to the consumers.
+     *
+     * @param[in] level Log level of the message.
+     * @param[in] format Format string of the message, with static storage duration.
+     * @param[in] args The variable argument list, which is not consumed by the function.
+     * @param[in] pSource Origin of the message, or nullptr if unknown.
+     *
+     * @return int Returns 0 if the message is queued or dropped, or -EAGAIN if the caller
+     *             must format the message and send it with HandleLogMessage() instead.
      */
-    static void HandleLogMessage(const uint8_t* pMessage, size_t length, int level);
+    static int HandleLogPackage(int level, const char* format, va_list args, const LogSource_t* pSource = nullptr);
+#endif
+#endif // CONFIG_COMMONS_LOGGING_DEFERRED
 
 private:
 
@@ -62,7 +187,7 @@ private:
      * This function is a thread entry point to process and send
      * all pending log messages to the registered consumers.
      *
-     * @param arg1 Unused argument.
+     * @param arg1 Read cursor of the log thread, which selects its consumer with CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS.
      * @param arg2 Unused argument.
      * @param arg3 Unused argument.
      */
@@ -72,13 +197,163 @@ private:
      * @brief Flushes all queued log messages immediately.
      *
      * This function is called when panic mode is enabled to ensure that all
-     * pending log messages are sent out without delay.
+     * pending log messages are sent out without delay. It returns immediately
+     * if another context is already flushing the logs. The log messages of
+     * all the log queues are merged in the order of their sequence numbers,
+     * and handed over to the consumers in batches.
      */
     static void Flushlogs();
 
-    inline static uint32_t mLogThresholdCounter = 0;  // Counter for tracking log message threshold
-    static struct k_sem    mDataReadySem;             // Semaphore to signal that data is ready for processing
+    /**
+     * @brief Hands over the oldest queued log messages to the consumers, up to the given count.
+     *
+     * It returns immediately if another context is already flushing the logs of the cursor. The dropped log
+     * messages are only reported once all the queued log messages are handed over.
+     *
+     * @param[in] cursor The read cursor, with the consumer it hands over to.
+     * @param[in] maxCount Maximum number of log messages to hand over.
+     *
+     * @return size_t Number of log messages handed over.
+     */
+    static size_t DrainLogs(size_t cursor, size_t maxCount);
+
+    /**
+     * @brief Drains a batch of log messages in the producer context, to make room for a log message.
+     *
+     * @param[in,out] budget Number of log messages the producer may still drain, decreased by the drained count.
+     *
+     * @return bool Returns true if the producer should retry queuing its log message, or false if the budget is spent.
+     */
+    static bool MakeRoom(size_t &budget);
+
+    /**
+     * @brief Pushes a log message to the log queue of the calling context.
+     *
+     * If the log queue is full, the calling thread may first wait for the log thread to make room,
+     * see SetBlockingTimeout(). Then the oldest log messages are drained batch by batch and the push is
+     * retried, until it succeeds or CONFIG_COMMONS_LOGGING_DRAIN_BUDGET log messages are drained.
+     *
+     * @param[in] pMessage Pointer to the log message.
+     * @param[in] length Length of the log message.
+     * @param[in] level Log level of the message, as stored in the log queue.
+     * @param[in] pSource Origin of the message, or nullptr if unknown.
+     *
+     * @return int Returns 0 on success, or -ENOBUFS if the message is dropped.
+     */
+    static int QueueLogMessage(const uint8_t* pMessage, size_t length, int level, const LogSource_t* pSource);
+
+#if CONFIG_COMMONS_LOGGING_DEFERRED_FORMAT
+    /**
+     * @brief Formats the packed log messages of a batch.
+     *
+     * The formatted messages replace the packages in the batch records.
+     *
+     * @param[in] cursor The read cursor of the batch, which owns the formatting buffers.
+     * @param[in,out] pBatch Pointer to the batch records.
+     * @param[in] count Number of records in the batch.
+     */
+    static void FormatLogPackages(size_t cursor, LogRecord_t* pBatch, size_t count);
+#endif
+
+#if !CONFIG_COMMONS_LOGGING_TOKENIZED
+    /**
+     * @brief Sends a log message with the number of log messages dropped since the previous report, if any.
+     *
+     * It is called once the queued log messages are flushed, so the report follows them.
+     *
+     * @param[in] cursor The read cursor, whose consumers receive the report.
+     */
+    static void ReportDroppedLogs(size_t cursor);
+#endif
+
+    /**
+     * @brief Wakes up the log threads, unless they are already woken up and have not run yet.
+     *
+     * @param[in] flush True if the log thread must flush, false to only start its timeout.
+     */
+    static void WakeLogThread(bool flush);
+
+#if CONFIG_COMMONS_LOGGING_BLOCKING
+    /**
+     * @brief Waits for the log thread to make room in a full log queue, and pushes the log message.
+     *
+     * @param[in] logQueue The log queue of the calling context.
+     * @param[in] pMessage Pointer to the log message.
+     * @param[in] length Length of the log message.
+     * @param[in] level Log level of the message, as stored in the log queue.
+     * @param[in] pSource Origin of the message, or nullptr if unknown.
+     *
+     * @return int Returns 0 on success, or an error code if the timeout of the calling thread expired.
+     */
+    static int WaitAndPushLog(LogQueue &logQueue, const uint8_t* pMessage, size_t length, int level, const LogSource_t* pSource);
+#endif
+
+    /**
+     * @brief Counts a queued log message and wakes up the log thread when a flush is due.
+     *
+     * A flush is due when the threshold of log messages is reached, when the log queue is filled above
+     * the watermark, or for a log message of the priority lane. The first log message after a flush
+     * also wakes up the log thread, to start the timeout of CONFIG_COMMONS_LOGGING_WAKEUP_TIMEOUT_MS.
+     * The log thread is only woken up once until it runs.
+     *
+     * @param[in] logQueue The log queue holding the message.
+     * @param[in] level Log level of the queued message.
+     */
+    static void NotifyLogThread(const LogQueue &logQueue, int level);
+
+    /**
+     * @brief Checks if a log message goes to the priority lane.
+     *
+     * @param[in] level Log level of the message, as queued.
+     *
+     * @return bool Returns true for the warnings and more severe log messages when the priority lane is enabled.
+     */
+    static bool IsPriorityLevel(int level);
+
+    /**
+     * @brief Selects the log queue of the calling context.
+     *
+     * With the priority lane, the warnings and more severe log messages go to the priority lane.
+     *
+     * @param[in] level Log level of the message.
+     *
+     * @return LogQueue& Reference to the log queue.
+     */
+    static LogQueue& GetLogQueue(int level);
+
+#if CONFIG_COMMONS_LOGGING_STATS
+    /**
+     * @brief Counts a log message handed over to the consumers, and checks that it follows the previous one.
+     *
+     * It must only be called from the flushing context of the cursor.
+     *
+     * @param[in] cursor The read cursor.
+     * @param[in] record The log message.
+     */
+    static void CountPulledLog(size_t cursor, const LogRecord_t &record);
+#endif
+
+    inline static std::atomic<uint32_t> mLogThresholdCounter = 0;     // Counter for tracking log message threshold
+    inline static std::atomic<bool>     mWakeupPending[LOG_CURSOR_COUNT] = {};    // Flag to indicate that the log thread is woken up and has not run yet
+    inline static std::atomic<bool>     mFlushRequested[LOG_CURSOR_COUNT] = {};   // Flag to indicate that the log thread must flush when it wakes up
+    inline static std::atomic<bool>     mFlushInProgress[LOG_CURSOR_COUNT] = {};  // Flag to indicate if a context is flushing the logs of the cursor
+    static LogOsSemaphore_t             mDataReadySem[LOG_CURSOR_COUNT];          // Semaphore to signal that data is ready for processing
+#if CONFIG_COMMONS_LOGGING_BLOCKING
+    inline static std::atomic<uint32_t> mSpaceWaiterCount = 0;        // Number of producers waiting for space in the log queues
+    static LogOsSemaphore_t             mSpaceAvailableSem;           // Semaphore to signal that space is released in the log queues
+#endif
+#if CONFIG_COMMONS_LOGGING_STATS
+    inline static std::atomic<uint32_t> mPushedCounts[LOG_STATS_LEVEL_COUNT] = {};    // Number of queued log messages per level
+    inline static std::atomic<uint32_t> mPulledCounts[LOG_STATS_LEVEL_COUNT] = {};    // Number of log messages handed over per level
+    inline static std::atomic<uint32_t> mHighWaterMark = 0;                            // Highest number of bytes used in a log queue
+    inline static std::atomic<uint32_t> mProducerFlushCount = 0;                       // Number of drains run by the producers
+    inline static std::atomic<uint32_t> mWakeupCount = 0;                              // Number of times the log thread was woken up
+#if LOG_STATS_SEQUENCE_GAP
+    inline static std::atomic<uint32_t> mSequenceGapCount = 0;                         // Number of pulled log messages out of sequence
+#endif
+#endif
 #endif // CONFIG_COMMONS_LOGGING_DEFERRED
 
-    inline static bool     mPanicModeEnabled = false; // Flag to indicate if panic mode is enabled
+    inline static bool                  mPanicModeEnabled = false;    // Flag to indicate if panic mode is enabled
+    inline static std::atomic<uint32_t> mLevelMask = UINT32_MAX;      // Mask of the log levels wanted by the consumers
 };
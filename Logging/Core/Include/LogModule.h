@@ -0,0 +1,98 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+/// @brief Module identifier of a source file which has not logged anything yet
+#define LOG_MODULE_ID_UNREGISTERED  (-1)
+
+// ----------------------------------------------------------------------------
+// Variable declarations
+// ----------------------------------------------------------------------------
+
+/// @brief Runtime log level of every registered module, indexed by module identifier.
+///        The last entry is shared by the modules which do not fit in the table.
+extern uint8_t gLogModuleLevels[CONFIG_COMMONS_LOGGING_MAX_MODULES + 1];
+
+// ----------------------------------------------------------------------------
+// Function declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Registers a module in the runtime log level table.
+ *
+ * If the module is already registered, its identifier is returned and its log level is kept.
+ *
+ * @param[in] pModuleName Name of the module, must have static storage duration.
+ * @param[in] level Initial log level of the module.
+ *
+ * @return int16_t Identifier of the module.
+ */
+int16_t LogModule_Register(const char* pModuleName, int level);
+
+/**
+ * @brief Sets the runtime log level of a module.
+ *
+ * The module is registered if it has not logged anything yet, so that its level can be set up front.
+ *
+ * @param[in] pModuleName Name of the module, must have static storage duration.
+ * @param[in] level Minimum log level of the module.
+ *
+ * @return int Returns 0 on success, or -ENOSPC if the module does not fit in the table.
+ */
+int LogModule_SetLevel(const char* pModuleName, int level);
+
+/**
+ * @brief Gets the runtime log level of a module.
+ *
+ * @param[in] pModuleName Name of the module.
+ *
+ * @return int Minimum log level of the module, or -ENOENT if the module is not registered.
+ */
+int LogModule_GetLevel(const char* pModuleName);
+
+/**
+ * @brief Checks if a log message of the module must be handled.
+ *
+ * After the first call from a source file, this is a single load from the runtime log level table.
+ *
+ * @param[in,out] pModuleId Identifier of the module cached by the calling source file.
+ * @param[in] pModuleName Name of the module.
+ * @param[in] defaultLevel Initial log level of the module.
+ * @param[in] level Log level of the message.
+ *
+ * @return bool Returns true if the log message must be handled, otherwise false.
+ */
+static inline bool LogModule_IsLevelEnabled(int16_t* pModuleId, const char* pModuleName, int defaultLevel, int level)
+{
+    int16_t moduleId = __atomic_load_n(pModuleId, __ATOMIC_RELAXED);
+    if (moduleId == LOG_MODULE_ID_UNREGISTERED)
+    {
+        moduleId = LogModule_Register(pModuleName, defaultLevel);
+        __atomic_store_n(pModuleId, moduleId, __ATOMIC_RELAXED);
+    }
+
+    return level >= __atomic_load_n(&gLogModuleLevels[moduleId], __ATOMIC_RELAXED);
+}
+
+#ifdef __cplusplus
+}
+#endif
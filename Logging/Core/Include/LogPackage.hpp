@@ -0,0 +1,61 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+// Class definition
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Captures a printf style log message without formatting it.
+ *
+ * A package holds the pointer to the format string, followed by the raw value of every argument.
+ * Strings are copied into the package, so they may be modified once the package is created.
+ * The format string itself is not copied, so it must have static storage duration, as string
+ * literals do.
+ */
+class LogPackage
+{
+public:
+    /**
+     * @brief Creates a package from the format string and its arguments.
+     *
+     * Strings which do not fit in the package are truncated.
+     *
+     * @param[out] pPackage Pointer to the buffer receiving the package.
+     * @param[in] size Size of the buffer in bytes.
+     * @param[in] format Format string with static storage duration.
+     * @param[in] args The variable argument list, consumed by the function.
+     *
+     * @return int Returns the length of the package on success, -ENOTSUP if the format string
+     *             contains a conversion which cannot be deferred, or -ENOBUFS if the arguments
+     *             do not fit in the buffer.
+     */
+    static int Pack(uint8_t* pPackage, size_t size, const char* format, va_list args);
+
+    /**
+     * @brief Formats a package created by Pack().
+     *
+     * The formatted message is truncated to fit in the buffer, and is always null terminated.
+     *
+     * @param[out] pMessage Pointer to the buffer receiving the formatted message.
+     * @param[in] size Size of the buffer in bytes.
+     * @param[in] pPackage Pointer to the package.
+     * @param[in] length Length of the package in bytes.
+     *
+     * @return size_t Returns the length of the formatted message, without the null terminator.
+     */
+    static size_t Format(char* pMessage, size_t size, const uint8_t* pPackage, size_t length);
+};
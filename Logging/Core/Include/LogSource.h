@@ -0,0 +1,111 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+/// @brief Source of a log call site which has not logged anything yet
+#define LOG_SOURCE_UNREGISTERED         (0)
+
+/// @brief Name identifier of the names which are not registered or do not fit in the table
+#define LOG_SOURCE_NAME_UNKNOWN         (UINT16_MAX)
+
+/// @brief Maximum length of a rendered prefix, including the null terminator
+#define LOG_SOURCE_PREFIX_MAX_LENGTH    (64)
+
+/// @brief Module and file name identifiers, packed into the flags passed through pigweed
+#define LOG_SOURCE_FLAGS(moduleId, fileId)  (((uint32_t)(moduleId) << 16) | (uint32_t)(fileId))
+#define LOG_SOURCE_MODULE_ID(flags)         ((uint16_t)((flags) >> 16))
+#define LOG_SOURCE_FILE_ID(flags)           ((uint16_t)((flags) & UINT16_MAX))
+
+// ----------------------------------------------------------------------------
+// Datatype definitions
+// ----------------------------------------------------------------------------
+
+// Origin of a log message, stored in the log metadata instead of a formatted prefix
+typedef struct
+{
+    uint16_t    moduleId;   // Name identifier of the module
+    uint16_t    fileId;     // Name identifier of the source file
+    uint16_t    line;       // Line number in the source file
+} LogSource_t;
+
+// ----------------------------------------------------------------------------
+// Function declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Registers the module and file names of a log call site.
+ *
+ * @param[in] pModuleName Name of the module, must have static storage duration.
+ * @param[in] pFileName Name of the source file, must have static storage duration.
+ *
+ * @return uint32_t The name identifiers, packed with LOG_SOURCE_FLAGS().
+ */
+uint32_t LogSource_Register(const char* pModuleName, const char* pFileName);
+
+/**
+ * @brief Gets a registered name.
+ *
+ * @param[in] nameId Identifier of the name.
+ *
+ * @return const char* The name, or "?" if the identifier is unknown.
+ */
+const char* LogSource_GetName(uint16_t nameId);
+
+/**
+ * @brief Renders the text prefix of a log message, like the default LOG_FORMAT does.
+ *
+ * @param[out] pPrefix Pointer to the buffer receiving the prefix.
+ * @param[in] size Size of the buffer in bytes.
+ * @param[in] level Log level of the message.
+ * @param[in] pSource Origin of the message.
+ *
+ * @return size_t Length of the prefix, without the null terminator. It is 0 for a zeroed source,
+ *                which is the source of the messages not logged through the logging macros.
+ */
+size_t LogSource_FormatPrefix(char* pPrefix, size_t size, int level, const LogSource_t* pSource);
+
+/**
+ * @brief Gets the name identifiers of a log call site.
+ *
+ * After the first call from a call site, this is a single load.
+ *
+ * @param[in,out] pFlags Name identifiers cached by the call site.
+ * @param[in] pModuleName Name of the module.
+ * @param[in] pFileName Name of the source file.
+ *
+ * @return uint32_t The name identifiers, packed with LOG_SOURCE_FLAGS().
+ */
+static inline uint32_t LogSource_GetFlags(uint32_t* pFlags, const char* pModuleName, const char* pFileName)
+{
+    uint32_t flags = __atomic_load_n(pFlags, __ATOMIC_RELAXED);
+    if (flags == LOG_SOURCE_UNREGISTERED)
+    {
+        flags = LogSource_Register(pModuleName, pFileName);
+        __atomic_store_n(pFlags, flags, __ATOMIC_RELAXED);
+    }
+
+    return flags;
+}
+
+#ifdef __cplusplus
+}
+#endif
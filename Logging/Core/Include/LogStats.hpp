@@ -0,0 +1,60 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+/// @brief Number of log levels with their own counters, the counters are indexed by the log level
+#define LOG_STATS_LEVEL_COUNT               (8)
+
+/// @brief Number of buckets of the consumer time histograms
+#define LOG_STATS_HISTOGRAM_BUCKET_COUNT    (16)
+
+/// @brief Only multiple log queues number the log messages when they are queued. A single log queue
+/// numbers them when they are pulled, so they always follow each other and a gap cannot be seen.
+#define LOG_STATS_SEQUENCE_GAP              (CONFIG_COMMONS_LOGGING_QUEUE_PER_CPU || CONFIG_COMMONS_LOGGING_QUEUE_PER_THREAD || \
+                                             CONFIG_COMMONS_LOGGING_PRIORITY_LANE)
+
+// ----------------------------------------------------------------------------
+// Datatype definitions
+// ----------------------------------------------------------------------------
+
+// Time spent by a consumer in ProcessLogBatch()
+typedef struct
+{
+    uint8_t     id;                 // Identifier of the consumer
+    bool        registered;         // The slot holds a registered consumer, the other fields are zero otherwise
+    uint64_t    totalTimeUs;        // Cumulative time in microseconds
+
+    // Number of calls per duration. Bucket 0 counts the calls below 1 us, bucket i the calls
+    // from 2^(i-1) us to 2^i us, and the last bucket all the longer calls.
+    uint32_t    timeHistogram[LOG_STATS_HISTOGRAM_BUCKET_COUNT];
+} LogConsumerStats_t;
+
+// Statistics of the deferred logging pipeline since the start, the counters wrap around
+typedef struct
+{
+    uint32_t            pushedCounts[LOG_STATS_LEVEL_COUNT];        // Log messages queued by the producers
+    uint32_t            pulledCounts[LOG_STATS_LEVEL_COUNT];        // Log messages handed over, once per cursor
+    uint32_t            droppedCounts[LOG_STATS_LEVEL_COUNT];       // Log messages dropped, by a full queue or an overflow
+    uint32_t            highWaterMark;                              // Highest number of bytes used in a log queue, headers included
+    uint32_t            producerFlushCount;                         // Drains run by the producers to make room in a full log queue
+    uint32_t            wakeupCount;                                // Times the semaphore of the log thread was given
+#if LOG_STATS_SEQUENCE_GAP
+    uint32_t            sequenceGapCount;                           // Pulled log messages which do not follow the previous one
+#endif
+    LogConsumerStats_t  consumers[CONFIG_COMMONS_LOGGING_MAX_CONSUMERS]; // Consumers, in the order of registration
+} LogStats_t;
@@ -0,0 +1,44 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ----------------------------------------------------------------------------
+// Function declarations
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Gets the current time of the log clock.
+ *
+ * It is called for every queued log message, so it must be cheap and callable from any context.
+ * The default clock is the 64 bit cycle counter on Zephyr, or CLOCK_MONOTONIC on the host.
+ * The application may provide its own clock by defining this function, along with
+ * LogTimestamp_GetFrequency().
+ *
+ * @return uint64_t The current time, in ticks of the log clock. It must never decrease.
+ */
+uint64_t LogTimestamp_Get(void);
+
+/**
+ * @brief Gets the frequency of the log clock, to convert the timestamps into time units.
+ *
+ * @return uint64_t Number of ticks of the log clock per second.
+ */
+uint64_t LogTimestamp_GetFrequency(void);
+
+#ifdef __cplusplus
+}
+#endif
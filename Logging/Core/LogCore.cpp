@@ -8,11 +8,27 @@
 // Header includes
 // ----------------------------------------------------------------------------
 
+#include "CommonTypes.h"
 #include "LogCore.hpp"
+#include "Assert.h"
 #if CONFIG_COMMONS_LOGGING_DEFERRED
     #include "LogQueue.hpp"
 #endif
+#if CONFIG_COMMONS_LOGGING_DEFERRED_FORMAT
+    #include "LogPackage.hpp"
+#endif
 #include "LogConsumer.hpp"
+#if CONFIG_COMMONS_LOGGING_DEFERRED
+    #include "Logging.h"
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if CONFIG_COMMONS_LOGGING_QUEUE_PER_THREAD && !CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+    #error "CONFIG_COMMONS_LOGGING_QUEUE_PER_THREAD requires CONFIG_COMMONS_LOGGING_QUEUE_MPSC"
+#endif
 
 // ----------------------------------------------------------------------------
 // Macro definitions
@@ -22,6 +38,38 @@
     // Define thread stack size and priority
     #define LOG_THREAD_STACK_SIZE   (1024)
     #define LOG_THREAD_PRIORITY     (5)
+
+    // Define the number of log queues
+    #if CONFIG_COMMONS_LOGGING_QUEUE_PER_CPU || CONFIG_COMMONS_LOGGING_QUEUE_PER_THREAD
+        #define LOG_QUEUE_COUNT     CONFIG_COMMONS_LOGGING_QUEUE_COUNT
+    #else
+        #define LOG_QUEUE_COUNT     (1)
+    #endif
+
+    // With the priority lane, every log queue has a second log queue for the warnings and more severe log messages.
+    // The log queues of the priority lane follow the log queues of the bulk lane.
+    #if CONFIG_COMMONS_LOGGING_PRIORITY_LANE
+        #define LOG_LANE_COUNT      (2)
+    #else
+        #define LOG_LANE_COUNT      (1)
+    #endif
+    #define LOG_TOTAL_QUEUE_COUNT   (LOG_QUEUE_COUNT * LOG_LANE_COUNT)
+
+    // Maximum number of log messages a producer drains to make room for its own, 0 is no limit
+    #if CONFIG_COMMONS_LOGGING_DRAIN_BUDGET > 0
+        #define LOG_DRAIN_BUDGET    static_cast<size_t>(CONFIG_COMMONS_LOGGING_DRAIN_BUDGET)
+    #else
+        #define LOG_DRAIN_BUDGET    SIZE_MAX
+    #endif
+
+    // Size of the report of the dropped log messages, enough for the counts of all the levels
+    #define LOG_DROPPED_LOGS_MESSAGE_SIZE   (128)
+#endif
+
+#if CONFIG_COMMONS_LOGGING_DEFERRED_FORMAT
+    // Flag set in the queued level of the log messages which are packed instead of formatted.
+    // The queue holds levels of 4 bits, so the flag is the highest bit of the nibble.
+    #define LOG_PACKAGE_FLAG        0x08
 #endif
 
 // ----------------------------------------------------------------------------
@@ -29,13 +77,59 @@
 // ----------------------------------------------------------------------------
 
 #if CONFIG_COMMONS_LOGGING_DEFERRED
-    // Thread stack
-    K_THREAD_STACK_DEFINE(gLogThreadStack, LOG_THREAD_STACK_SIZE);
+    // Thread stacks, one per read cursor
+    LOG_OS_THREAD_STACK_ARRAY_DEFINE(gLogThreadStacks, LOG_CURSOR_COUNT, LOG_THREAD_STACK_SIZE);
+
+    // Thread data structures
+    LogOsThread_t gLogThreadData[LOG_CURSOR_COUNT];
+
+    LogOsSemaphore_t LogCore::mDataReadySem[LOG_CURSOR_COUNT];
+
+    // Number of read cursors in use, and of log threads
+    size_t gLogCursorCount = 1;
+
+    #if CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS
+        // The read cursors are created from the consumers registered until then
+        bool gQueueInitialized = false;
+    #endif
+
+    #if CONFIG_COMMONS_LOGGING_BLOCKING
+        LogOsSemaphore_t LogCore::mSpaceAvailableSem;
+
+        // Time the calling thread waits for space in a full log queue
+        thread_local uint32_t gThreadBlockingTimeoutMs = CONFIG_COMMONS_LOGGING_BLOCKING_TIMEOUT_MS;
+    #endif
+
+    // Log queues of all the lanes, merged by sequence number when flushing
+    LogQueue gLogQueues[LOG_TOTAL_QUEUE_COUNT];
 
-    // Thread data structure
-    struct k_thread gLogThreadData;
+    #if CONFIG_COMMONS_LOGGING_QUEUE_PER_THREAD
+        // Log queue of the calling thread, the threads which are not registered share the first log queue,
+        // which is why it takes multiple producers
+        thread_local size_t gThreadLogQueueIndex = 0;
 
-    struct k_sem LogCore::mDataReadySem;
+        // Next log queue to assign to a registered thread
+        std::atomic<size_t> gNextLogQueueIndex = 1;
+    #endif
+
+    #if CONFIG_COMMONS_LOGGING_STATS && LOG_STATS_SEQUENCE_GAP
+        // Sequence number of the last log message handed over per cursor, only the flushing context writes it
+        uint32_t gLastPulledSequenceNumbers[LOG_CURSOR_COUNT] = {};
+        bool gLogsPulled[LOG_CURSOR_COUNT] = {};
+    #endif
+
+    #if !CONFIG_COMMONS_LOGGING_TOKENIZED
+        // Report of the dropped log messages per cursor, only the flushing context writes it
+        char gDroppedLogsMessages[LOG_CURSOR_COUNT][LOG_DROPPED_LOGS_MESSAGE_SIZE];
+    #endif
+
+    #if CONFIG_COMMONS_LOGGING_DEFERRED_FORMAT
+        // Formatted log messages of the batch being flushed per cursor. Only one context flushes a cursor at a time.
+        char gFormattedMessages[LOG_CURSOR_COUNT][CONFIG_COMMONS_LOGGING_BATCH_SIZE][CONFIG_COMMONS_LOGGING_BUFFER_SIZE + 1];
+
+        // Packed log message which wraps around the end of its log queue, copied to be contiguous
+        uint8_t gPackageBuffers[LOG_CURSOR_COUNT][CONFIG_COMMONS_LOGGING_BUFFER_SIZE];
+    #endif
 #endif
 
 // ----------------------------------------------------------------------------
@@ -44,24 +138,132 @@
 
 void LogCore::RegisterConsumer(uint8_t id, LogToOutput &consumer)
 {
+#if CONFIG_COMMONS_LOGGING_DEFERRED && CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS
+    // A consumer registered later would have neither a read cursor nor a log thread
+    ASSERT(!gQueueInitialized);
+#endif
+
     consumer.SetId(id);
     consumer.Initialize();
     LogConsumer::RegisterConsumer(consumer);
+
+    mLevelMask.store(LogConsumer::GetLevelMask(), std::memory_order_relaxed);
+}
+
+int LogCore::SetConsumerLevel(uint8_t id, int level)
+{
+    int rc = LogConsumer::SetConsumerLevel(id, level);
+    if (rc == 0)
+    {
+        mLevelMask.store(LogConsumer::GetLevelMask(), std::memory_order_relaxed);
+    }
+
+    return rc;
 }
 
 #if CONFIG_COMMONS_LOGGING_DEFERRED
 void LogCore::InitializeQueue(void* pBuffer, size_t bufferSize)
 {
-    LogQueue::Initialize(pBuffer, bufferSize);
+    uint8_t* pQueueBuffer = static_cast<uint8_t*>(pBuffer);
+
+#if CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS
+    // Every registered consumer reads the log queues with its own cursor, the one of its slot
+    gLogCursorCount = std::max(LogConsumer::GetConsumerCount(), static_cast<size_t>(1));
+    gQueueInitialized = true;
+#endif
+
+#if CONFIG_COMMONS_LOGGING_PRIORITY_LANE
+    // Set aside the space of the priority lane, split evenly between its log queues
+    size_t prioritySize = (bufferSize * CONFIG_COMMONS_LOGGING_PRIORITY_LANE_PERCENT) / 100;
+    size_t priorityQueueSize = prioritySize / LOG_QUEUE_COUNT;
+    for (size_t i = 0; i < LOG_QUEUE_COUNT; ++i)
+    {
+        gLogQueues[LOG_QUEUE_COUNT + i].Initialize(pQueueBuffer + (i * priorityQueueSize), priorityQueueSize, gLogCursorCount);
+
+        // The queue size is rounded down to a power of two, which must still hold a whole log message
+        ASSERT(gLogQueues[LOG_QUEUE_COUNT + i].GetMaxMessageLength() >= CONFIG_COMMONS_LOGGING_BUFFER_SIZE);
+    }
+
+    pQueueBuffer += prioritySize;
+    bufferSize -= prioritySize;
+#endif
+
+    // Split the rest of the buffer evenly between the log queues
+    size_t queueSize = bufferSize / LOG_QUEUE_COUNT;
+    for (size_t i = 0; i < LOG_QUEUE_COUNT; ++i)
+    {
+        gLogQueues[i].Initialize(pQueueBuffer + (i * queueSize), queueSize, gLogCursorCount);
+    }
+
+    // Initialize the binary semaphores for data ready signal, before the threads wait for them
+    for (size_t i = 0; i < gLogCursorCount; ++i)
+    {
+        LogOs::InitializeSemaphore(mDataReadySem[i]);
+    }
+#if CONFIG_COMMONS_LOGGING_BLOCKING
+    LogOs::InitializeSemaphore(mSpaceAvailableSem);
+#endif
+
+    // Create and start a thread per read cursor
+    for (size_t i = 0; i < gLogCursorCount; ++i)
+    {
+        LogOs::CreateThread(gLogThreadData[i], gLogThreadStacks[i], LOG_OS_THREAD_STACK_SIZEOF(gLogThreadStacks[i]),
+                            LogCore::LogThreadEntry, LOG_THREAD_PRIORITY, reinterpret_cast<void*>(i));
+    }
+}
+
+#if CONFIG_COMMONS_LOGGING_QUEUE_PER_THREAD
+int LogCore::RegisterThread()
+{
+    size_t queueIndex = gNextLogQueueIndex.fetch_add(1, std::memory_order_relaxed);
+    if (queueIndex >= LOG_QUEUE_COUNT)
+    {
+        // All the dedicated log queues are already assigned, keep using the shared one
+        return -ENOSPC;
+    }
 
-    // Create and start the thread
-    k_thread_create(&gLogThreadData, gLogThreadStack, LOG_THREAD_STACK_SIZE,
-                    LogCore::LogThreadEntry, NULL, NULL, NULL,
-                    LOG_THREAD_PRIORITY, 0, K_NO_WAIT);
+    gThreadLogQueueIndex = queueIndex;
 
-    // Initialize the binary semaphore for data ready signal
-    k_sem_init(&mDataReadySem, 0, 1);
+    return 0;
 }
+#endif // CONFIG_COMMONS_LOGGING_QUEUE_PER_THREAD
+
+#if CONFIG_COMMONS_LOGGING_BLOCKING
+void LogCore::SetBlockingTimeout(uint32_t timeoutMs)
+{
+    gThreadBlockingTimeoutMs = timeoutMs;
+}
+#endif
+
+#if CONFIG_COMMONS_LOGGING_STATS
+void LogCore::GetStats(LogStats_t &stats)
+{
+    uint32_t droppedCounts[LogQueue::cLevelCount];
+
+    stats = {};
+    for (size_t i = 0; i < LOG_STATS_LEVEL_COUNT; ++i)
+    {
+        stats.pushedCounts[i] = mPushedCounts[i].load(std::memory_order_relaxed);
+        stats.pulledCounts[i] = mPulledCounts[i].load(std::memory_order_relaxed);
+    }
+
+    // The packed log messages are counted with their level
+    LogQueue::GetTotalDroppedLogs(droppedCounts);
+    for (size_t i = 0; i < LogQueue::cLevelCount; ++i)
+    {
+        stats.droppedCounts[i % LOG_STATS_LEVEL_COUNT] += droppedCounts[i];
+    }
+
+    stats.highWaterMark = mHighWaterMark.load(std::memory_order_relaxed);
+    stats.producerFlushCount = mProducerFlushCount.load(std::memory_order_relaxed);
+    stats.wakeupCount = mWakeupCount.load(std::memory_order_relaxed);
+#if LOG_STATS_SEQUENCE_GAP
+    stats.sequenceGapCount = mSequenceGapCount.load(std::memory_order_relaxed);
+#endif
+
+    LogConsumer::GetConsumerStats(stats.consumers);
+}
+#endif // CONFIG_COMMONS_LOGGING_STATS
 #endif // CONFIG_COMMONS_LOGGING_DEFERRED
 
 void LogCore::EnablePanicMode()
@@ -74,10 +276,16 @@ void LogCore::EnablePanicMode()
 #endif
 }
 
-void LogCore::HandleLogMessage(const uint8_t* pMessage, size_t length, int level)
+void LogCore::HandleLogMessage(const uint8_t* pMessage, size_t length, int level, const LogSource_t* pSource)
 {
     bool deferredLogging = false;
 
+    if (!IsLevelEnabled(level))
+    {
+        // No consumer wants the log message, so it is not even queued
+        return;
+    }
+
 #if CONFIG_COMMONS_LOGGING_DEFERRED
     deferredLogging = true;
 #endif
@@ -85,38 +293,120 @@ void LogCore::HandleLogMessage(const uint8_t* pMessage, size_t length, int level
     if (!deferredLogging || mPanicModeEnabled)
     {
         // In immediate mode, we send the log message immediately without queuing
-        LogConsumer::SendLogMessage(pMessage, length, level);
+        LogConsumer::SendLogMessage(pMessage, length, level, pSource);
     }
 #if CONFIG_COMMONS_LOGGING_DEFERRED
     else
     {
         // In deferred mode, we can queue the log message and process later
-        int rc = LogQueue::PushLog(pMessage, length, level);
-        if (rc)
-        {
-            // If pushing to the queue fails, flush all logs immediately.
-            Flushlogs();
+        QueueLogMessage(pMessage, length, level, pSource);
+    }
+#endif // CONFIG_COMMONS_LOGGING_DEFERRED
+}
 
-            // After flushing, try to push the log message again
-            rc = LogQueue::PushLog(pMessage, length, level);
-            if (rc)
-            {
-                // If it still fails, we drop the log message
-                return;
-            }
-        }
+#if CONFIG_COMMONS_LOGGING_DEFERRED
+int LogCore::ReserveLogMessage(uint8_t* &pSlot, size_t maxLength, int level)
+{
+#if CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+    UNUSED(pSlot);
+    UNUSED(maxLength);
+    UNUSED(level);
 
-        mLogThresholdCounter++;
+    // With multiple producers, the space is claimed up front and cannot be shrunk on commit.
+    // So the log message is formatted first and queued with its exact length.
+    return -EAGAIN;
+#else
+    if (mPanicModeEnabled)
+    {
+        // In panic mode, the log message is sent immediately without queuing
+        return -EAGAIN;
+    }
 
-        if (mLogThresholdCounter >= CONFIG_COMMONS_LOGGING_THRESHOLD)
+    pSlot = GetLogQueue(level).Reserve(maxLength);
+    if (pSlot == nullptr)
+    {
+        // The log message is formatted first and queued by copy, which makes room for it within the drain budget.
+        // A large slot may also not fit contiguously at the current position, even in an empty queue,
+        // and a slot larger than the whole queue never fits.
+        return -EAGAIN;
+    }
+
+    return 0;
+#endif // CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+}
+
+void LogCore::CommitLogMessage(size_t length, int level, const LogSource_t* pSource)
+{
+#if CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+    UNUSED(length);
+    UNUSED(level);
+    UNUSED(pSource);
+#else
+    LogQueue &logQueue = GetLogQueue(level);
+    logQueue.Commit(length, level, pSource);
+
+    if (length > 0)
+    {
+        NotifyLogThread(logQueue, level);
+    }
+#endif
+}
+
+#if CONFIG_COMMONS_LOGGING_DEFERRED_FORMAT
+int LogCore::HandleLogPackage(int level, const char* format, va_list args, const LogSource_t* pSource)
+{
+    constexpr size_t cPackageSize = CONFIG_COMMONS_LOGGING_BUFFER_SIZE;
+    int packageLength = 0;
+    va_list packageArgs;
+
+    if (!IsLevelEnabled(level))
+    {
+        // No consumer wants the log message, so it is not even packed
+        return 0;
+    }
+
+    // The arguments are packed from a copy, so that the caller can still format them on failure
+    uint8_t* pSlot = nullptr;
+    if (ReserveLogMessage(pSlot, cPackageSize, level) == 0)
+    {
+        // Pack the log message directly into the log queue
+        va_copy(packageArgs, args);
+        packageLength = LogPackage::Pack(pSlot, cPackageSize, format, packageArgs);
+        va_end(packageArgs);
+
+        if (packageLength < 0)
         {
-            // If the threshold is reached, signal the log thread to process the logs
-            mLogThresholdCounter = 0;
-            k_sem_give(&mDataReadySem);
+            // Give the slot back, the caller formats the log message instead
+            CommitLogMessage(0, level);
+            return -EAGAIN;
         }
+
+        CommitLogMessage(packageLength, level | LOG_PACKAGE_FLAG, pSource);
+        return 0;
     }
-#endif // CONFIG_COMMONS_LOGGING_DEFERRED
+    else if (mPanicModeEnabled)
+    {
+        // In panic mode, the log message is formatted and sent immediately
+        return -EAGAIN;
+    }
+
+    // The space in the log queue cannot be reserved, so the package is built on the stack and copied
+    uint8_t package[cPackageSize];
+    va_copy(packageArgs, args);
+    packageLength = LogPackage::Pack(package, cPackageSize, format, packageArgs);
+    va_end(packageArgs);
+
+    if (packageLength < 0)
+    {
+        return -EAGAIN;
+    }
+
+    QueueLogMessage(package, packageLength, level | LOG_PACKAGE_FLAG, pSource);
+
+    return 0;
 }
+#endif // CONFIG_COMMONS_LOGGING_DEFERRED_FORMAT
+#endif // CONFIG_COMMONS_LOGGING_DEFERRED
 
 // ----------------------------------------------------------------------------
 // Private functions
@@ -125,32 +415,463 @@ void LogCore::HandleLogMessage(const uint8_t* pMessage, size_t length, int level
 #if CONFIG_COMMONS_LOGGING_DEFERRED
 void LogCore::LogThreadEntry(void* arg1, void* arg2, void* arg3)
 {
+    size_t cursor = reinterpret_cast<uintptr_t>(arg1);
+    uint32_t timeoutMs = LOG_OS_WAIT_FOREVER;
+
+#if CONFIG_COMMONS_LOGGING_BLOCKING
+    // The log thread would wait for itself to make room
+    SetBlockingTimeout(0);
+#endif
+
     while (1)
     {
         // Wait for data ready signal before processing logs
-        k_sem_take(&mDataReadySem, K_FOREVER);
+        bool signaled = LogOs::TakeSemaphore(mDataReadySem[cursor], timeoutMs);
+
+        // From now on, the producers wake up the log thread again. The flags are sequentially consistent,
+        // so that a flush requested while the log thread wakes up is seen by either side.
+        mWakeupPending[cursor].store(false);
 
-        Flushlogs();
+        if (signaled && !mFlushRequested[cursor].exchange(false))
+        {
+            // The first log message after a flush was queued, it is flushed at the latest when the timeout expires
+            timeoutMs = CONFIG_COMMONS_LOGGING_WAKEUP_TIMEOUT_MS;
+            continue;
+        }
+
+        // The log messages queued from now on count toward the next flush
+        mLogThresholdCounter.store(0, std::memory_order_relaxed);
+        timeoutMs = LOG_OS_WAIT_FOREVER;
+
+        DrainLogs(cursor, SIZE_MAX);
     }
 }
 
 void LogCore::Flushlogs()
 {
-    uint8_t* pMessage = nullptr;
-    size_t messageLength = 0;
-    int level = 0;
+    for (size_t i = 0; i < gLogCursorCount; ++i)
+    {
+        DrainLogs(i, SIZE_MAX);
+    }
+}
+
+size_t LogCore::DrainLogs(size_t cursor, size_t maxCount)
+{
+    LogRecord_t heads[LOG_TOTAL_QUEUE_COUNT];
+    bool pending[LOG_TOTAL_QUEUE_COUNT];
+    LogRecord_t batch[CONFIG_COMMONS_LOGGING_BATCH_SIZE];
+    size_t batchCount = 0;
+    size_t batchLimit = 0;
+    size_t drainedCount = 0;
+
+    // A cursor has a single consumer, so only one context flushes it at a time
+    if (mFlushInProgress[cursor].exchange(true, std::memory_order_acquire))
+    {
+        return 0;
+    }
+
+    do
+    {
+#if CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS && (CONFIG_COMMONS_LOGGING_CONSUMER_MAX_LAG > 0)
+        // A consumer which lags too far behind skips the oldest log messages, so that it does not hold the space of the others
+        for (size_t i = 0; i < LOG_TOTAL_QUEUE_COUNT; ++i)
+        {
+            gLogQueues[i].SkipLogs(cursor, (gLogQueues[i].GetSize() * CONFIG_COMMONS_LOGGING_CONSUMER_MAX_LAG) / 100);
+        }
+#endif
+
+        // Peek the first log message of every log queue
+        for (size_t i = 0; i < LOG_TOTAL_QUEUE_COUNT; ++i)
+        {
+            pending[i] = (gLogQueues[i].PeekLog(heads[i], cursor) == 0);
+        }
+
+        batchCount = 0;
+        batchLimit = std::min(static_cast<size_t>(CONFIG_COMMONS_LOGGING_BATCH_SIZE), maxCount - drainedCount);
+        while (batchCount < batchLimit)
+        {
+            // Pick the oldest log message across the log queues, the sequence number may wrap around
+            size_t oldest = LOG_TOTAL_QUEUE_COUNT;
+            for (size_t i = 0; i < LOG_TOTAL_QUEUE_COUNT; ++i)
+            {
+                if (pending[i] &&
+                    ((oldest == LOG_TOTAL_QUEUE_COUNT) ||
+                     (static_cast<int32_t>(heads[i].sequenceNumber - heads[oldest].sequenceNumber) < 0)))
+                {
+                    oldest = i;
+                }
+            }
+
+            if (oldest == LOG_TOTAL_QUEUE_COUNT)
+            {
+                // No more log messages to process
+                break;
+            }
+
+#if CONFIG_COMMONS_LOGGING_STATS
+            CountPulledLog(cursor, heads[oldest]);
+#endif
+            batch[batchCount++] = heads[oldest];
+            pending[oldest] = (gLogQueues[oldest].PeekLog(heads[oldest], cursor) == 0);
+        }
+
+        for (size_t i = 0; i < LOG_TOTAL_QUEUE_COUNT; ++i)
+        {
+            if (pending[i])
+            {
+                // The log message did not fit in the batch, keep it for the next one
+                gLogQueues[i].UnpeekLog(cursor);
+            }
+        }
+
+        if (batchCount > 0)
+        {
+#if CONFIG_COMMONS_LOGGING_DEFERRED_FORMAT
+            // Format the packed log messages just before the consumers run
+            FormatLogPackages(cursor, batch, batchCount);
+#endif
+
+            // Send the log messages straight from the queue buffers
+#if CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS
+            LogConsumer::SendLogBatch(cursor, batch, batchCount);
+#else
+            LogConsumer::SendLogBatch(batch, batchCount);
+#endif
+        }
+
+        // The consumers of the cursor are done with the log messages, so their space can be reused once
+        // all the cursors released them. This also releases the skipped padding or invalid data, if any.
+        for (size_t i = 0; i < LOG_TOTAL_QUEUE_COUNT; ++i)
+        {
+            gLogQueues[i].ReleaseLogs(cursor);
+        }
+
+#if CONFIG_COMMONS_LOGGING_BLOCKING
+        if ((batchCount > 0) && (mSpaceWaiterCount.load() > 0))
+        {
+            // Let a waiting producer retry, it wakes up the next one
+            LogOs::GiveSemaphore(mSpaceAvailableSem);
+        }
+#endif
+
+        drainedCount += batchCount;
+    } while ((batchCount == batchLimit) && (drainedCount < maxCount));
+
+#if !CONFIG_COMMONS_LOGGING_TOKENIZED
+    if (batchCount < batchLimit)
+    {
+        // The consumers caught up with the log queues, tell them what was lost on the way
+        ReportDroppedLogs(cursor);
+    }
+#endif
+
+    mFlushInProgress[cursor].store(false, std::memory_order_release);
+
+    return drainedCount;
+}
+
+bool LogCore::MakeRoom(size_t &budget)
+{
+#if CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS
+    // Draining one cursor does not free any space while the other cursors lag behind,
+    // and the producer would run the consumers of the other log threads.
+    UNUSED(budget);
+
+    return false;
+#else
+    if (budget == 0)
+    {
+        return false;
+    }
+
+    size_t drainedCount = DrainLogs(0, std::min(budget, static_cast<size_t>(CONFIG_COMMONS_LOGGING_BATCH_SIZE)));
+
+#if CONFIG_COMMONS_LOGGING_STATS
+    if (drainedCount > 0)
+    {
+        mProducerFlushCount.fetch_add(1, std::memory_order_relaxed);
+    }
+#endif
+
+    // When nothing is drained, the log queues are empty or another context is flushing them.
+    // The log message is retried once more, the other context may have made room for it.
+    budget = (drainedCount == 0) ? 0 : (budget - drainedCount);
+
+    return true;
+#endif
+}
+
+int LogCore::QueueLogMessage(const uint8_t* pMessage, size_t length, int level, const LogSource_t* pSource)
+{
+    LogQueue &logQueue = GetLogQueue(level);
+    size_t drainBudget = LOG_DRAIN_BUDGET;
+
+    int rc = logQueue.PushLog(pMessage, length, level, pSource);
+#if CONFIG_COMMONS_LOGGING_BLOCKING
+    if ((rc != 0) && (gThreadBlockingTimeoutMs > 0) && !mPanicModeEnabled && LogOs::CanBlock())
+    {
+        rc = WaitAndPushLog(logQueue, pMessage, length, level, pSource);
+    }
+#endif
+    while ((rc != 0) && MakeRoom(drainBudget))
+    {
+        // Only the log messages needed to fit this one are drained by the producer, the log thread drains the rest
+        rc = logQueue.PushLog(pMessage, length, level, pSource);
+    }
+
+    if (rc != 0)
+    {
+        // If it still fails, we drop the log message
+        LogQueue::CountDroppedLog(level);
+        return -ENOBUFS;
+    }
+
+    NotifyLogThread(logQueue, level);
+
+    return 0;
+}
+
+#if CONFIG_COMMONS_LOGGING_BLOCKING
+int LogCore::WaitAndPushLog(LogQueue &logQueue, const uint8_t* pMessage, size_t length, int level, const LogSource_t* pSource)
+{
+    uint32_t timeoutMs = gThreadBlockingTimeoutMs;
+    uint32_t startMs = LogOs::GetTimeMs();
+    uint32_t elapsedMs = 0;
+    int rc = 0;
+
+    // The producer is counted before the log thread is woken up, so that the log thread signals it
+    mSpaceWaiterCount.fetch_add(1);
 
     do
     {
-        int rc = LogQueue::PullLog(pMessage, messageLength, level);
-        if (rc)
+        WakeLogThread(true);
+
+        // Space released before the wait is not missed, the semaphore stays given
+        LogOs::TakeSemaphore(mSpaceAvailableSem, timeoutMs - elapsedMs);
+
+        rc = logQueue.PushLog(pMessage, length, level, pSource);
+        elapsedMs = LogOs::GetTimeMs() - startMs;
+    } while ((rc != 0) && (elapsedMs < timeoutMs));
+
+    if (mSpaceWaiterCount.fetch_sub(1) > 1)
+    {
+        // Only one producer is woken up at a time, pass the signal on to the next one
+        LogOs::GiveSemaphore(mSpaceAvailableSem);
+    }
+
+    return rc;
+}
+#endif // CONFIG_COMMONS_LOGGING_BLOCKING
+
+#if CONFIG_COMMONS_LOGGING_DEFERRED_FORMAT
+void LogCore::FormatLogPackages(size_t cursor, LogRecord_t* pBatch, size_t count)
+{
+    uint8_t (&packageBuffer)[CONFIG_COMMONS_LOGGING_BUFFER_SIZE] = gPackageBuffers[cursor];
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        LogRecord_t &record = pBatch[i];
+        if ((record.level & LOG_PACKAGE_FLAG) == 0)
+        {
+            // Already formatted by the producer
+            continue;
+        }
+
+        const uint8_t* pPackage = record.segments[0].pData;
+        size_t packageLength = record.segments[0].length;
+        if (record.segmentCount > 1)
+        {
+            // The package wraps around the end of the log queue, join its segments
+            packageLength = 0;
+            for (size_t j = 0; j < record.segmentCount; ++j)
+            {
+                size_t copyLength = std::min(record.segments[j].length, sizeof(packageBuffer) - packageLength);
+                memcpy(packageBuffer + packageLength, record.segments[j].pData, copyLength);
+                packageLength += copyLength;
+            }
+            pPackage = packageBuffer;
+        }
+
+        char (&formattedMessage)[CONFIG_COMMONS_LOGGING_BUFFER_SIZE + 1] = gFormattedMessages[cursor][i];
+        size_t messageLength = LogPackage::Format(formattedMessage, sizeof(formattedMessage), pPackage, packageLength);
+
+        record.segments[0] = { .pData = reinterpret_cast<const uint8_t*>(formattedMessage), .length = messageLength };
+        record.segmentCount = 1;
+        record.level &= ~LOG_PACKAGE_FLAG;
+    }
+}
+#endif // CONFIG_COMMONS_LOGGING_DEFERRED_FORMAT
+
+#if !CONFIG_COMMONS_LOGGING_TOKENIZED
+void LogCore::ReportDroppedLogs(size_t cursor)
+{
+    static const char* const cLevelNames[] = { LOG_LEVEL_DEBUG_STR, LOG_LEVEL_INFO_STR, LOG_LEVEL_WARN_STR,
+                                                LOG_LEVEL_ERROR_STR, LOG_LEVEL_CRITICAL_STR };
+    uint32_t queuedCounts[LogQueue::cLevelCount];
+    uint32_t counts[LOG_LEVEL_CRITICAL + 1] = {};
+    char (&droppedLogsMessage)[LOG_DROPPED_LOGS_MESSAGE_SIZE] = gDroppedLogsMessages[cursor];
+
+    uint32_t droppedCount = LogQueue::TakeDroppedLogs(queuedCounts, cursor);
+    if (droppedCount == 0)
+    {
+        return;
+    }
+
+    // Merge the counts of the packed log messages with the counts of their level
+    int level = LOG_LEVEL_WARN;
+    for (size_t i = 0; i < LogQueue::cLevelCount; ++i)
+    {
+        size_t countLevel = i;
+#if CONFIG_COMMONS_LOGGING_DEFERRED_FORMAT
+        countLevel &= ~static_cast<size_t>(LOG_PACKAGE_FLAG);
+#endif
+        if ((queuedCounts[i] > 0) && (countLevel <= LOG_LEVEL_CRITICAL))
+        {
+            counts[countLevel] += queuedCounts[i];
+
+            // The report is at least a warning, and as severe as the most severe dropped log message
+            level = std::max(level, static_cast<int>(countLevel));
+        }
+    }
+
+    size_t length = snprintf(droppedLogsMessage, sizeof(droppedLogsMessage), "Dropped %u log messages (",
+                             static_cast<unsigned int>(droppedCount));
+    const char* pSeparator = "";
+    for (int i = LOG_LEVEL_CRITICAL; i >= LOG_LEVEL_DEBUG; --i)
+    {
+        if (counts[i] > 0)
+        {
+            length += snprintf(&droppedLogsMessage[length], sizeof(droppedLogsMessage) - length, "%s%s %u",
+                               pSeparator, cLevelNames[i - LOG_LEVEL_DEBUG], static_cast<unsigned int>(counts[i]));
+            pSeparator = ", ";
+        }
+    }
+    length += snprintf(&droppedLogsMessage[length], sizeof(droppedLogsMessage) - length, ")\n");
+    ASSERT(length < sizeof(droppedLogsMessage));
+
+    LogRecord_t record = { .segments       = { { .pData  = reinterpret_cast<const uint8_t*>(droppedLogsMessage),
+                                                 .length = length } },
+                           .segmentCount   = 1,
+                           .level          = level,
+                           .sequenceNumber = 0,
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+                           .source         = {},
+#endif
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+                           .timestamp      = LogTimestamp_Get(),
+#endif
+                         };
+#if CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS
+    LogConsumer::SendLogBatch(cursor, &record, 1);
+#else
+    LogConsumer::SendLogBatch(&record, 1);
+#endif
+}
+#endif // !CONFIG_COMMONS_LOGGING_TOKENIZED
+
+bool LogCore::IsPriorityLevel(int level)
+{
+#if CONFIG_COMMONS_LOGGING_PRIORITY_LANE
+#if CONFIG_COMMONS_LOGGING_DEFERRED_FORMAT
+    level &= ~LOG_PACKAGE_FLAG;
+#endif
+
+    return level >= LOG_LEVEL_WARN;
+#else
+    UNUSED(level);
+
+    return false;
+#endif
+}
+
+LogQueue& LogCore::GetLogQueue(int level)
+{
+    size_t queueIndex = 0;
+
+#if CONFIG_COMMONS_LOGGING_QUEUE_PER_CPU
+    // Contexts on the same CPU may still preempt each other, which is why multiple producers are required
+    queueIndex = LogOs::GetCpuId() % LOG_QUEUE_COUNT;
+#elif CONFIG_COMMONS_LOGGING_QUEUE_PER_THREAD
+    queueIndex = gThreadLogQueueIndex;
+#endif
+
+    if (IsPriorityLevel(level))
+    {
+        // The log queue of the priority lane is owned by the same producers as its bulk log queue
+        queueIndex += LOG_QUEUE_COUNT;
+    }
+
+    return gLogQueues[queueIndex];
+}
+
+#if CONFIG_COMMONS_LOGGING_STATS
+void LogCore::CountPulledLog(size_t cursor, const LogRecord_t &record)
+{
+    // The packed log messages are counted with their level
+    mPulledCounts[record.level % LOG_STATS_LEVEL_COUNT].fetch_add(1, std::memory_order_relaxed);
+
+#if LOG_STATS_SEQUENCE_GAP
+    // A gap is a log message lost by a full queue, or a log message of another queue committed late
+    if (gLogsPulled[cursor] && (record.sequenceNumber != (gLastPulledSequenceNumbers[cursor] + 1)))
+    {
+        mSequenceGapCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    gLastPulledSequenceNumbers[cursor] = record.sequenceNumber;
+    gLogsPulled[cursor] = true;
+#else
+    UNUSED(cursor);
+#endif
+}
+#endif // CONFIG_COMMONS_LOGGING_STATS
+
+void LogCore::NotifyLogThread(const LogQueue &logQueue, int level)
+{
+    uint32_t logCount = mLogThresholdCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+    size_t usedSize = logQueue.GetUsedSize();
+
+#if CONFIG_COMMONS_LOGGING_STATS
+    mPushedCounts[level % LOG_STATS_LEVEL_COUNT].fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t highWaterMark = mHighWaterMark.load(std::memory_order_relaxed);
+    while ((usedSize > highWaterMark) &&
+           !mHighWaterMark.compare_exchange_weak(highWaterMark, static_cast<uint32_t>(usedSize), std::memory_order_relaxed))
+    {
+        // Another producer raised the high-water mark in the meantime, compare with its value
+    }
+#endif
+
+    // Few large log messages can fill the log queue before the threshold is reached
+    bool aboveWatermark = (usedSize * 100) >= (logQueue.GetSize() * CONFIG_COMMONS_LOGGING_WAKEUP_WATERMARK);
+
+    if ((logCount >= CONFIG_COMMONS_LOGGING_THRESHOLD) || aboveWatermark || IsPriorityLevel(level))
+    {
+        WakeLogThread(true);
+    }
+    else if ((logCount == 1) && (CONFIG_COMMONS_LOGGING_WAKEUP_TIMEOUT_MS > 0))
+    {
+        // The log thread does not know about the queued log messages yet, and does not wait for the threshold
+        WakeLogThread(false);
+    }
+}
+
+void LogCore::WakeLogThread(bool flush)
+{
+    for (size_t i = 0; i < gLogCursorCount; ++i)
+    {
+        if (flush)
         {
-            // No more log messages to process
-            break;
+            mFlushRequested[i].store(true);
         }
 
-        // Send the log message to all registered consumers
-        LogConsumer::SendLogMessage(pMessage, messageLength, level);
-    } while (pMessage);
+        // Wake up the log thread only once, a burst of log messages would give the semaphore over and over
+        if (!mWakeupPending[i].exchange(true))
+        {
+            LogOs::GiveSemaphore(mDataReadySem[i]);
+#if CONFIG_COMMONS_LOGGING_STATS
+            mWakeupCount.fetch_add(1, std::memory_order_relaxed);
+#endif
+        }
+    }
 }
 #endif // CONFIG_COMMONS_LOGGING_DEFERRED
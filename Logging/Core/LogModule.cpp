@@ -0,0 +1,124 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogModule.h"
+#include "Assert.h"
+
+#include <atomic>
+#include <cstring>
+#include <errno.h>
+
+// ----------------------------------------------------------------------------
+// Variable definitions
+// ----------------------------------------------------------------------------
+
+// Runtime log level of every registered module. The shared entry enables all the levels.
+uint8_t gLogModuleLevels[CONFIG_COMMONS_LOGGING_MAX_MODULES + 1];
+
+// Name of every registered module. A claimed entry stays null until its name is written.
+static std::atomic<const char*> gLogModuleNames[CONFIG_COMMONS_LOGGING_MAX_MODULES];
+
+// Number of claimed entries in the table
+static std::atomic<int16_t> gLogModuleCount = 0;
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Finds a registered module by name.
+ *
+ * @param[in] pModuleName Name of the module.
+ *
+ * @return int16_t Identifier of the module, or LOG_MODULE_ID_UNREGISTERED if not found.
+ */
+static int16_t FindModule(const char* pModuleName)
+{
+    int16_t moduleCount = gLogModuleCount.load(std::memory_order_acquire);
+
+    for (int16_t i = 0; i < moduleCount; ++i)
+    {
+        const char* pName = gLogModuleNames[i].load(std::memory_order_acquire);
+        if ((pName != nullptr) && ((pName == pModuleName) || (strcmp(pName, pModuleName) == 0)))
+        {
+            return i;
+        }
+    }
+
+    return LOG_MODULE_ID_UNREGISTERED;
+}
+
+// ----------------------------------------------------------------------------
+// Public functions
+// ----------------------------------------------------------------------------
+
+int16_t LogModule_Register(const char* pModuleName, int level)
+{
+    ASSERT(pModuleName != nullptr);
+
+    int16_t moduleId = FindModule(pModuleName);
+    if (moduleId != LOG_MODULE_ID_UNREGISTERED)
+    {
+        return moduleId;
+    }
+
+    // Claim a new entry without a lock, so that modules can register from any context
+    moduleId = gLogModuleCount.load(std::memory_order_relaxed);
+    do
+    {
+        if (moduleId >= CONFIG_COMMONS_LOGGING_MAX_MODULES)
+        {
+            // The table is full, share the entry which enables all the levels
+            return CONFIG_COMMONS_LOGGING_MAX_MODULES;
+        }
+    } while (!gLogModuleCount.compare_exchange_weak(moduleId, moduleId + 1, std::memory_order_relaxed));
+
+    // The level is written before the name, so it is valid once the entry can be found
+    __atomic_store_n(&gLogModuleLevels[moduleId], static_cast<uint8_t>(level), __ATOMIC_RELAXED);
+    gLogModuleNames[moduleId].store(pModuleName, std::memory_order_release);
+
+    return moduleId;
+}
+
+int LogModule_SetLevel(const char* pModuleName, int level)
+{
+    ASSERT(pModuleName != nullptr);
+
+    int16_t moduleId = LogModule_Register(pModuleName, level);
+    if (moduleId == CONFIG_COMMONS_LOGGING_MAX_MODULES)
+    {
+        return -ENOSPC;
+    }
+
+    // Concurrent first registrations may have claimed more than one entry for the module, update all of them
+    for (int16_t i = moduleId; i < CONFIG_COMMONS_LOGGING_MAX_MODULES; ++i)
+    {
+        const char* pName = gLogModuleNames[i].load(std::memory_order_acquire);
+        if ((pName != nullptr) && (strcmp(pName, pModuleName) == 0))
+        {
+            __atomic_store_n(&gLogModuleLevels[i], static_cast<uint8_t>(level), __ATOMIC_RELAXED);
+        }
+    }
+
+    return 0;
+}
+
+int LogModule_GetLevel(const char* pModuleName)
+{
+    ASSERT(pModuleName != nullptr);
+
+    int16_t moduleId = FindModule(pModuleName);
+    if (moduleId == LOG_MODULE_ID_UNREGISTERED)
+    {
+        return -ENOENT;
+    }
+
+    return __atomic_load_n(&gLogModuleLevels[moduleId], __ATOMIC_RELAXED);
+}
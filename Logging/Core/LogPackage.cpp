@@ -0,0 +1,511 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogPackage.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <errno.h>
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+// Maximum length of a single conversion specification, once the '*' are replaced by their values
+#define LOG_CONVERSION_MAX_LENGTH   (32)
+
+// ----------------------------------------------------------------------------
+// Datatype definitions
+// ----------------------------------------------------------------------------
+
+// Type of the argument consumed by a conversion specification
+typedef enum
+{
+    LOG_ARG_NONE,               // No argument, as for "%%"
+    LOG_ARG_INT,
+    LOG_ARG_LONG,
+    LOG_ARG_LONG_LONG,
+    LOG_ARG_INTMAX,
+    LOG_ARG_SIZE,
+    LOG_ARG_PTRDIFF,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_LONG_DOUBLE,
+    LOG_ARG_POINTER,
+    LOG_ARG_STRING,
+    LOG_ARG_UNSUPPORTED,        // Wide characters and "%n", or an incomplete conversion
+} LogArgType_t;
+
+// Conversion specification parsed from the format string
+typedef struct
+{
+    const char*     pStart;         // Pointer to the '%' character
+    const char*     pEnd;           // Pointer past the conversion character
+    bool            starWidth;      // The width is given as an int argument
+    bool            starPrecision;  // The precision is given as an int argument
+    LogArgType_t    type;           // Type of the argument
+} LogConversion_t;
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Parses the conversion specification starting at the '%' character.
+ *
+ * The packing and the formatting parse the format string the same way, so that
+ * the arguments are read back with the types they were written with.
+ *
+ * @param[in] pStart Pointer to the '%' character.
+ * @param[out] conversion The parsed conversion specification.
+ */
+static void ParseConversion(const char* pStart, LogConversion_t& conversion)
+{
+    const char* p = pStart + 1;
+
+    conversion = { .pStart = pStart, .pEnd = nullptr, .starWidth = false, .starPrecision = false, .type = LOG_ARG_NONE };
+
+    // Flags
+    while ((*p == '-') || (*p == '+') || (*p == ' ') || (*p == '#') || (*p == '0'))
+    {
+        ++p;
+    }
+
+    // Width
+    if (*p == '*')
+    {
+        conversion.starWidth = true;
+        ++p;
+    }
+    while ((*p >= '0') && (*p <= '9'))
+    {
+        ++p;
+    }
+
+    // Precision
+    if (*p == '.')
+    {
+        ++p;
+        if (*p == '*')
+        {
+            conversion.starPrecision = true;
+            ++p;
+        }
+        while ((*p >= '0') && (*p <= '9'))
+        {
+            ++p;
+        }
+    }
+
+    // Length modifier
+    LogArgType_t integerType = LOG_ARG_INT;
+    bool longModifier = false;
+    bool longDoubleModifier = false;
+    switch (*p)
+    {
+    case 'h':
+        p += (p[1] == 'h') ? 2 : 1;
+        break;
+    case 'l':
+        if (p[1] == 'l')
+        {
+            integerType = LOG_ARG_LONG_LONG;
+            p += 2;
+        }
+        else
+        {
+            integerType = LOG_ARG_LONG;
+            longModifier = true;
+            p += 1;
+        }
+        break;
+    case 'j':
+        integerType = LOG_ARG_INTMAX;
+        ++p;
+        break;
+    case 'z':
+        integerType = LOG_ARG_SIZE;
+        ++p;
+        break;
+    case 't':
+        integerType = LOG_ARG_PTRDIFF;
+        ++p;
+        break;
+    case 'L':
+        longDoubleModifier = true;
+        ++p;
+        break;
+    default:
+        break;
+    }
+
+    // Conversion
+    switch (*p)
+    {
+    case '%':
+        conversion.type = LOG_ARG_NONE;
+        break;
+    case 'd':
+    case 'i':
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+        conversion.type = longDoubleModifier ? LOG_ARG_UNSUPPORTED : integerType;
+        break;
+    case 'c':
+        conversion.type = (longModifier || longDoubleModifier) ? LOG_ARG_UNSUPPORTED : LOG_ARG_INT;
+        break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        conversion.type = longDoubleModifier ? LOG_ARG_LONG_DOUBLE : LOG_ARG_DOUBLE;
+        break;
+    case 's':
+        conversion.type = (longModifier || longDoubleModifier) ? LOG_ARG_UNSUPPORTED : LOG_ARG_STRING;
+        break;
+    case 'p':
+        conversion.type = LOG_ARG_POINTER;
+        break;
+    default:
+        conversion.type = LOG_ARG_UNSUPPORTED;
+        break;
+    }
+
+    conversion.pEnd = (*p != '\0') ? (p + 1) : p;
+}
+
+/**
+ * @brief Appends a value to the package.
+ *
+ * @param[in,out] pPackage Write position in the package, advanced past the value.
+ * @param[in] pPackageEnd Pointer past the end of the package buffer.
+ * @param[in] value The value to append.
+ *
+ * @return bool Returns true on success, or false if the value does not fit.
+ */
+template <typename T>
+static bool PackValue(uint8_t* &pPackage, const uint8_t* pPackageEnd, T value)
+{
+    if (static_cast<size_t>(pPackageEnd - pPackage) < sizeof(T))
+    {
+        return false;
+    }
+
+    // The package is not aligned, so the value is copied byte by byte
+    memcpy(pPackage, &value, sizeof(T));
+    pPackage += sizeof(T);
+
+    return true;
+}
+
+/**
+ * @brief Reads a value from the package.
+ *
+ * @param[in,out] pPackage Read position in the package, advanced past the value.
+ * @param[in] pPackageEnd Pointer past the end of the package.
+ * @param[out] value The value read.
+ *
+ * @return bool Returns true on success, or false if the package is too short.
+ */
+template <typename T>
+static bool UnpackValue(const uint8_t* &pPackage, const uint8_t* pPackageEnd, T &value)
+{
+    if (static_cast<size_t>(pPackageEnd - pPackage) < sizeof(T))
+    {
+        return false;
+    }
+
+    memcpy(&value, pPackage, sizeof(T));
+    pPackage += sizeof(T);
+
+    return true;
+}
+
+/**
+ * @brief Formats a single argument from the package and appends it to the message.
+ *
+ * @param[in] pMessage Pointer to the message buffer.
+ * @param[in] size Size of the message buffer in bytes.
+ * @param[in] position Length of the message so far.
+ * @param[in] pSpecification Null terminated conversion specification.
+ * @param[in] value The argument.
+ *
+ * @return size_t Returns the new length of the message.
+ */
+template <typename T>
+static size_t FormatValue(char* pMessage, size_t size, size_t position, const char* pSpecification, T value)
+{
+    int formattedLength = snprintf(pMessage + position, size - position, pSpecification, value);
+    if (formattedLength < 0)
+    {
+        return position;
+    }
+
+    // On truncation, the message ends at the null terminator written by snprintf
+    return std::min(position + static_cast<size_t>(formattedLength), size - 1);
+}
+
+// ----------------------------------------------------------------------------
+// Public functions
+// ----------------------------------------------------------------------------
+
+int LogPackage::Pack(uint8_t* pPackage, size_t size, const char* format, va_list args)
+{
+    uint8_t* pWrite = pPackage;
+    const uint8_t* pPackageEnd = pPackage + size;
+    bool fits = PackValue(pWrite, pPackageEnd, format);
+
+    for (const char* p = strchr(format, '%'); fits && (p != nullptr); p = strchr(p, '%'))
+    {
+        LogConversion_t conversion;
+        ParseConversion(p, conversion);
+        p = conversion.pEnd;
+
+        if (conversion.type == LOG_ARG_UNSUPPORTED)
+        {
+            return -ENOTSUP;
+        }
+
+        if (conversion.starWidth)
+        {
+            fits = fits && PackValue(pWrite, pPackageEnd, va_arg(args, int));
+        }
+        if (conversion.starPrecision)
+        {
+            fits = fits && PackValue(pWrite, pPackageEnd, va_arg(args, int));
+        }
+
+        switch (conversion.type)
+        {
+        case LOG_ARG_INT:
+            fits = fits && PackValue(pWrite, pPackageEnd, va_arg(args, int));
+            break;
+        case LOG_ARG_LONG:
+            fits = fits && PackValue(pWrite, pPackageEnd, va_arg(args, long));
+            break;
+        case LOG_ARG_LONG_LONG:
+            fits = fits && PackValue(pWrite, pPackageEnd, va_arg(args, long long));
+            break;
+        case LOG_ARG_INTMAX:
+            fits = fits && PackValue(pWrite, pPackageEnd, va_arg(args, intmax_t));
+            break;
+        case LOG_ARG_SIZE:
+            fits = fits && PackValue(pWrite, pPackageEnd, va_arg(args, size_t));
+            break;
+        case LOG_ARG_PTRDIFF:
+            fits = fits && PackValue(pWrite, pPackageEnd, va_arg(args, ptrdiff_t));
+            break;
+        case LOG_ARG_DOUBLE:
+            fits = fits && PackValue(pWrite, pPackageEnd, va_arg(args, double));
+            break;
+        case LOG_ARG_LONG_DOUBLE:
+            fits = fits && PackValue(pWrite, pPackageEnd, va_arg(args, long double));
+            break;
+        case LOG_ARG_POINTER:
+            fits = fits && PackValue(pWrite, pPackageEnd, va_arg(args, void*));
+            break;
+        case LOG_ARG_STRING:
+        {
+            const char* pString = va_arg(args, const char*);
+            if (pString == nullptr)
+            {
+                pString = "(null)";
+            }
+
+            if (!fits || (pWrite == pPackageEnd))
+            {
+                fits = false;
+                break;
+            }
+
+            // The string is copied with its null terminator, and truncated if needed
+            size_t stringLength = strnlen(pString, static_cast<size_t>(pPackageEnd - pWrite) - 1);
+            memcpy(pWrite, pString, stringLength);
+            pWrite[stringLength] = '\0';
+            pWrite += stringLength + 1;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    if (!fits)
+    {
+        return -ENOBUFS;
+    }
+
+    return static_cast<int>(pWrite - pPackage);
+}
+
+size_t LogPackage::Format(char* pMessage, size_t size, const uint8_t* pPackage, size_t length)
+{
+    const uint8_t* pRead = pPackage;
+    const uint8_t* pPackageEnd = pPackage + length;
+    const char* format = nullptr;
+    size_t position = 0;
+
+    if ((size == 0) || !UnpackValue(pRead, pPackageEnd, format))
+    {
+        return 0;
+    }
+
+    pMessage[0] = '\0';
+
+    const char* p = format;
+    while (*p != '\0')
+    {
+        // Copy the text up to the next conversion specification
+        const char* pConversionStart = strchr(p, '%');
+        size_t textLength = (pConversionStart != nullptr) ? static_cast<size_t>(pConversionStart - p) : strlen(p);
+        size_t copyLength = std::min(textLength, size - 1 - position);
+        memcpy(pMessage + position, p, copyLength);
+        position += copyLength;
+        pMessage[position] = '\0';
+
+        if (pConversionStart == nullptr)
+        {
+            break;
+        }
+
+        LogConversion_t conversion;
+        ParseConversion(pConversionStart, conversion);
+        p = conversion.pEnd;
+
+        // Build the conversion specification, with the '*' replaced by the values from the package
+        char specification[LOG_CONVERSION_MAX_LENGTH];
+        size_t specificationLength = 0;
+        bool valid = (conversion.type != LOG_ARG_UNSUPPORTED);
+        for (const char* c = conversion.pStart; valid && (c < conversion.pEnd); ++c)
+        {
+            int written = 0;
+            if (*c == '*')
+            {
+                int value = 0;
+                valid = UnpackValue(pRead, pPackageEnd, value);
+                if ((value < 0) && (c[-1] == '.'))
+                {
+                    // A negative precision is taken as if the precision were omitted
+                    --specificationLength;
+                    continue;
+                }
+                written = snprintf(specification + specificationLength, sizeof(specification) - specificationLength, "%d", value);
+            }
+            else
+            {
+                written = snprintf(specification + specificationLength, sizeof(specification) - specificationLength, "%c", *c);
+            }
+
+            valid = valid && (written > 0) && (specificationLength + written < sizeof(specification));
+            specificationLength += valid ? written : 0;
+        }
+
+        if (!valid)
+        {
+            // The package does not match its format string, so nothing more can be formatted
+            break;
+        }
+
+        switch (conversion.type)
+        {
+        case LOG_ARG_NONE:
+            position = FormatValue(pMessage, size, position, "%s", "%");
+            break;
+        case LOG_ARG_INT:
+        {
+            int value;
+            valid = UnpackValue(pRead, pPackageEnd, value);
+            position = valid ? FormatValue(pMessage, size, position, specification, value) : position;
+            break;
+        }
+        case LOG_ARG_LONG:
+        {
+            long value;
+            valid = UnpackValue(pRead, pPackageEnd, value);
+            position = valid ? FormatValue(pMessage, size, position, specification, value) : position;
+            break;
+        }
+        case LOG_ARG_LONG_LONG:
+        {
+            long long value;
+            valid = UnpackValue(pRead, pPackageEnd, value);
+            position = valid ? FormatValue(pMessage, size, position, specification, value) : position;
+            break;
+        }
+        case LOG_ARG_INTMAX:
+        {
+            intmax_t value;
+            valid = UnpackValue(pRead, pPackageEnd, value);
+            position = valid ? FormatValue(pMessage, size, position, specification, value) : position;
+            break;
+        }
+        case LOG_ARG_SIZE:
+        {
+            size_t value;
+            valid = UnpackValue(pRead, pPackageEnd, value);
+            position = valid ? FormatValue(pMessage, size, position, specification, value) : position;
+            break;
+        }
+        case LOG_ARG_PTRDIFF:
+        {
+            ptrdiff_t value;
+            valid = UnpackValue(pRead, pPackageEnd, value);
+            position = valid ? FormatValue(pMessage, size, position, specification, value) : position;
+            break;
+        }
+        case LOG_ARG_DOUBLE:
+        {
+            double value;
+            valid = UnpackValue(pRead, pPackageEnd, value);
+            position = valid ? FormatValue(pMessage, size, position, specification, value) : position;
+            break;
+        }
+        case LOG_ARG_LONG_DOUBLE:
+        {
+            long double value;
+            valid = UnpackValue(pRead, pPackageEnd, value);
+            position = valid ? FormatValue(pMessage, size, position, specification, value) : position;
+            break;
+        }
+        case LOG_ARG_POINTER:
+        {
+            void* value;
+            valid = UnpackValue(pRead, pPackageEnd, value);
+            position = valid ? FormatValue(pMessage, size, position, specification, value) : position;
+            break;
+        }
+        case LOG_ARG_STRING:
+        {
+            // The string is stored null terminated in the package
+            const char* pString = reinterpret_cast<const char*>(pRead);
+            size_t stringLength = strnlen(pString, static_cast<size_t>(pPackageEnd - pRead));
+            valid = (pRead + stringLength < pPackageEnd);
+            pRead += stringLength + 1;
+            position = valid ? FormatValue(pMessage, size, position, specification, pString) : position;
+            break;
+        }
+        default:
+            break;
+        }
+
+        if (!valid)
+        {
+            break;
+        }
+    }
+
+    return position;
+}
@@ -0,0 +1,132 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogSource.h"
+#include "Logging.h"
+#include "Assert.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+// Variable definitions
+// ----------------------------------------------------------------------------
+
+// Registered module and file names. A claimed entry stays null until its name is written.
+static std::atomic<const char*> gLogSourceNames[CONFIG_COMMONS_LOGGING_MAX_SOURCE_NAMES];
+
+// Number of claimed entries in the table
+static std::atomic<uint16_t> gLogSourceNameCount = 0;
+
+// Text of every log level, as rendered in the prefix
+static const char* const gLogLevelNames[] =
+{
+    "",
+    LOG_LEVEL_DEBUG_STR,
+    LOG_LEVEL_INFO_STR,
+    LOG_LEVEL_WARN_STR,
+    LOG_LEVEL_ERROR_STR,
+    LOG_LEVEL_CRITICAL_STR,
+};
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Registers a name, or finds it if it is already registered.
+ *
+ * @param[in] pName The name, must have static storage duration.
+ *
+ * @return uint16_t Identifier of the name, or LOG_SOURCE_NAME_UNKNOWN if the table is full.
+ */
+static uint16_t RegisterName(const char* pName)
+{
+    uint16_t nameCount = gLogSourceNameCount.load(std::memory_order_acquire);
+
+    for (uint16_t i = 0; i < nameCount; ++i)
+    {
+        const char* pRegisteredName = gLogSourceNames[i].load(std::memory_order_acquire);
+        if ((pRegisteredName != nullptr) && ((pRegisteredName == pName) || (strcmp(pRegisteredName, pName) == 0)))
+        {
+            return i + 1;
+        }
+    }
+
+    // Claim a new entry without a lock, so that names can be registered from any context
+    do
+    {
+        if (nameCount >= CONFIG_COMMONS_LOGGING_MAX_SOURCE_NAMES)
+        {
+            return LOG_SOURCE_NAME_UNKNOWN;
+        }
+    } while (!gLogSourceNameCount.compare_exchange_weak(nameCount, nameCount + 1, std::memory_order_relaxed));
+
+    gLogSourceNames[nameCount].store(pName, std::memory_order_release);
+
+    // The identifiers start at 1, so that the flags of a registered call site are never zero
+    return nameCount + 1;
+}
+
+// ----------------------------------------------------------------------------
+// Public functions
+// ----------------------------------------------------------------------------
+
+uint32_t LogSource_Register(const char* pModuleName, const char* pFileName)
+{
+    ASSERT(pModuleName != nullptr);
+    ASSERT(pFileName != nullptr);
+
+    return LOG_SOURCE_FLAGS(RegisterName(pModuleName), RegisterName(pFileName));
+}
+
+const char* LogSource_GetName(uint16_t nameId)
+{
+    if ((nameId == 0) || (nameId > CONFIG_COMMONS_LOGGING_MAX_SOURCE_NAMES))
+    {
+        return "?";
+    }
+
+    const char* pName = gLogSourceNames[nameId - 1].load(std::memory_order_acquire);
+
+    return (pName != nullptr) ? pName : "?";
+}
+
+size_t LogSource_FormatPrefix(char* pPrefix, size_t size, int level, const LogSource_t* pSource)
+{
+    ASSERT(pPrefix != nullptr);
+    ASSERT(pSource != nullptr);
+
+    if ((pSource->moduleId == 0) && (pSource->fileId == 0))
+    {
+        // The log message was not logged through the logging macros
+        if (size > 0)
+        {
+            pPrefix[0] = '\0';
+        }
+        return 0;
+    }
+
+    const char* pLevelName = ((level >= 0) && (static_cast<size_t>(level) < (sizeof(gLogLevelNames) / sizeof(gLogLevelNames[0])))) ?
+                             gLogLevelNames[level] : "";
+
+    int prefixLength = snprintf(pPrefix, size, "<%s|%s|%s:%u> - ", pLevelName,
+                                LogSource_GetName(pSource->moduleId),
+                                LogSource_GetName(pSource->fileId),
+                                static_cast<unsigned int>(pSource->line));
+    if ((prefixLength < 0) || (size == 0))
+    {
+        return 0;
+    }
+
+    return std::min(static_cast<size_t>(prefixLength), size - 1);
+}
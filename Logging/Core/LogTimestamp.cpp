@@ -0,0 +1,54 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogTimestamp.h"
+
+#if defined(__ZEPHYR__)
+    #include <zephyr/kernel.h>
+#else
+    #include <time.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// Public functions
+// ----------------------------------------------------------------------------
+
+// The default clock is weak, so that the application can replace it
+
+__attribute__((weak)) uint64_t LogTimestamp_Get(void)
+{
+#if defined(__ZEPHYR__)
+    #if CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER
+        return k_cycle_get_64();
+    #else
+        // The 32 bit cycle counter wraps within seconds, so fall back to the system ticks
+        return static_cast<uint64_t>(k_uptime_ticks());
+    #endif
+#else
+    // Served by the vDSO on Linux, so it does not enter the kernel
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (static_cast<uint64_t>(now.tv_sec) * 1000000000ULL) + static_cast<uint64_t>(now.tv_nsec);
+#endif
+}
+
+__attribute__((weak)) uint64_t LogTimestamp_GetFrequency(void)
+{
+#if defined(__ZEPHYR__)
+    #if CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER
+        return sys_clock_hw_cycles_per_sec();
+    #else
+        return CONFIG_SYS_CLOCK_TICKS_PER_SEC;
+    #endif
+#else
+    return 1000000000ULL;
+#endif
+}
@@ -38,21 +38,53 @@ NOTE: Before including this header file, the following macros must be defined by
 #define MODULE_LOG_LEVEL        LOG_LEVEL_DEBUG
 #endif
 
-// Set default log message format if not defined by application
+// Set default log message format if not defined by application.
+// With structured prefix, the level, module, file and line are stored as metadata and rendered by the consumers.
 #ifndef LOG_FORMAT
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+#define LOG_FORMAT(level, module, file, line, message) message "\n"
+#else
 #define LOG_FORMAT(level, module, file, line, message) "<" level "|" module "|" file ":" line "> - " message "\n"
 #endif
+#endif
+
+// With runtime filtering, MODULE_LOG_LEVEL is only the initial level of the module. So all levels are compiled in.
+#if CONFIG_COMMONS_LOGGING_RUNTIME_FILTER
+#define LOG_COMPILED_LEVEL      LOG_LEVEL_DEBUG
+#else
+#define LOG_COMPILED_LEVEL      MODULE_LOG_LEVEL
+#endif
 
 // Must be included after the module name, log level and log format definitions
 #include "LoggingBackend.h"
 
+#if CONFIG_COMMONS_LOGGING_RUNTIME_FILTER
+#include "LogModule.h"
+
+// Identifier of the module in the runtime log level table, cached per source file on the first log message
+static int16_t sLogModuleId __attribute__((unused)) = LOG_MODULE_ID_UNREGISTERED;
+
+#define LOG_IS_LEVEL_ENABLED(level) LogModule_IsLevelEnabled(&sLogModuleId, LOG_MODULE_NAME, MODULE_LOG_LEVEL, level)
+#else
+#define LOG_IS_LEVEL_ENABLED(level) (true)
+#endif
+
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+// Module and file name identifiers of the call site, registered on its first log message
+#define LOG_CALL_SITE_DEFINE() static uint32_t sLogSourceFlags = LOG_SOURCE_UNREGISTERED
+#else
+#define LOG_CALL_SITE_DEFINE() do { } while (false)
+#endif
+
 #define LOG(level, level_string, fmt, ...)                        \
     do {                                                          \
         COMPILE_ASSERT(                                           \
             (level) >= LOG_LEVEL_OMIT &&                          \
             (level) <= LOG_LEVEL_CRITICAL,                        \
             "Invalid log level");                                 \
-        if ((level) != LOG_LEVEL_OMIT) {                          \
+        LOG_CALL_SITE_DEFINE();                                   \
+        if ((level) != LOG_LEVEL_OMIT &&                          \
+            LOG_IS_LEVEL_ENABLED(level)) {                        \
             LOG_MESSAGE(level, level_string, fmt, ##__VA_ARGS__); \
         }                                                         \
     } while (false)
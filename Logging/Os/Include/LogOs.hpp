@@ -0,0 +1,162 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__ZEPHYR__)
+    #include <zephyr/kernel.h>
+#else
+    #include <pthread.h>
+
+    #include <thread>
+#endif
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+/// @brief Timeout of a wait which never expires
+#define LOG_OS_WAIT_FOREVER     UINT32_MAX
+
+#if defined(__ZEPHYR__)
+    /// @brief Defines the stack of a thread, at file scope
+    #define LOG_OS_THREAD_STACK_DEFINE(name, size)  K_THREAD_STACK_DEFINE(name, size)
+
+    /// @brief Defines the stacks of several threads, at file scope
+    #define LOG_OS_THREAD_STACK_ARRAY_DEFINE(name, count, size) K_THREAD_STACK_ARRAY_DEFINE(name, count, size)
+
+    /// @brief Gets the usable size of a stack defined with LOG_OS_THREAD_STACK_DEFINE()
+    #define LOG_OS_THREAD_STACK_SIZEOF(name)        K_THREAD_STACK_SIZEOF(name)
+#else
+    // Host threads get their stack from the OS, so the stack is only a placeholder
+    #define LOG_OS_THREAD_STACK_DEFINE(name, size)  LogOsStack_t name[1]
+    #define LOG_OS_THREAD_STACK_ARRAY_DEFINE(name, count, size) LogOsStack_t name[count][1]
+    #define LOG_OS_THREAD_STACK_SIZEOF(name)        sizeof(name)
+#endif
+
+// ----------------------------------------------------------------------------
+// Datatype definitions
+// ----------------------------------------------------------------------------
+
+// Entry point of a thread, with the Zephyr signature
+typedef void (*LogOsThreadEntry_t)(void* arg1, void* arg2, void* arg3);
+
+#if defined(__ZEPHYR__)
+    typedef k_thread_stack_t    LogOsStack_t;       // Stack of a thread
+    typedef struct k_thread     LogOsThread_t;      // Thread
+    typedef struct k_sem        LogOsSemaphore_t;   // Binary semaphore
+#else
+    typedef uint8_t             LogOsStack_t;       // Stack of a thread, unused
+    typedef std::thread         LogOsThread_t;      // Thread
+
+    // Binary semaphore. The POSIX primitives are never destroyed, unlike the standard library ones,
+    // which would wait at exit for the log thread blocked on them.
+    typedef struct
+    {
+        pthread_mutex_t         mutex;              // Protects the signaled flag
+        pthread_cond_t          condition;          // Signaled when the semaphore is given
+        bool                    signaled;           // Semaphore is given and not taken yet
+    } LogOsSemaphore_t;
+#endif
+
+// ----------------------------------------------------------------------------
+// Class definition
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Thin layer over the OS primitives used by deferred logging.
+ *
+ * The Zephyr kernel is used when built with Zephyr, and the C++ standard library threads with
+ * POSIX semaphores otherwise, so that the deferred logging also runs on host builds.
+ */
+class LogOs
+{
+public:
+    /**
+     * @brief Creates and starts a thread.
+     *
+     * @param[out] thread The thread data.
+     * @param[in] pStack Pointer to the stack defined with LOG_OS_THREAD_STACK_DEFINE().
+     * @param[in] stackSize Size of the stack, from LOG_OS_THREAD_STACK_SIZEOF().
+     * @param[in] entry Entry point of the thread.
+     * @param[in] priority Priority of the thread, ignored on host builds.
+     * @param[in] pArg First argument of the entry point, the others are null.
+     */
+    static void CreateThread(LogOsThread_t &thread, LogOsStack_t* pStack, size_t stackSize,
+                             LogOsThreadEntry_t entry, int priority, void* pArg = nullptr);
+
+    /**
+     * @brief Initializes a binary semaphore, not given.
+     *
+     * @param[out] semaphore The semaphore.
+     */
+    static void InitializeSemaphore(LogOsSemaphore_t &semaphore);
+
+    /**
+     * @brief Gives a binary semaphore. Giving it again before it is taken has no effect.
+     *
+     * It can be called from any context, including ISRs.
+     *
+     * @param[in,out] semaphore The semaphore.
+     */
+    static void GiveSemaphore(LogOsSemaphore_t &semaphore);
+
+    /**
+     * @brief Takes a binary semaphore, waiting until it is given or the timeout expires.
+     *
+     * @param[in,out] semaphore The semaphore.
+     * @param[in] timeoutMs Maximum time to wait in milliseconds, 0 to not wait, or LOG_OS_WAIT_FOREVER.
+     *
+     * @return bool Returns true if the semaphore was taken, or false if the timeout expired.
+     */
+    static bool TakeSemaphore(LogOsSemaphore_t &semaphore, uint32_t timeoutMs);
+
+    /**
+     * @brief Checks if the caller may block.
+     *
+     * ISRs and the threads which are not preemptible, like the cooperative Zephyr threads, must not block.
+     *
+     * @return bool Returns true if the caller may wait on a semaphore.
+     */
+    static bool CanBlock();
+
+    /**
+     * @brief Gets the time since the system start.
+     *
+     * @return uint32_t Time in milliseconds, wraps around.
+     */
+    static uint32_t GetTimeMs();
+
+    /**
+     * @brief Gets the hardware cycle counter, to measure short durations.
+     *
+     * @return uint32_t Cycle count, wraps around.
+     */
+    static uint32_t GetCycleCount();
+
+    /**
+     * @brief Converts a duration measured with GetCycleCount() to microseconds.
+     *
+     * @param[in] cycles Number of cycles.
+     *
+     * @return uint32_t Duration in microseconds.
+     */
+    static uint32_t CyclesToUs(uint32_t cycles);
+
+    /**
+     * @brief Gets the identifier of the CPU running the caller.
+     *
+     * @return uint32_t The CPU identifier, always 0 when it is unknown.
+     */
+    static uint32_t GetCpuId();
+};
@@ -0,0 +1,202 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogOs.hpp"
+#include "CommonTypes.h"
+
+#if !defined(__ZEPHYR__)
+    #include <time.h>
+#endif
+#if !defined(__ZEPHYR__) && defined(__linux__)
+    #include <sched.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+#if !defined(__ZEPHYR__)
+// Clock of the timed waits, which a step of the wall clock must not stretch. macOS only waits on the realtime clock.
+#if defined(__APPLE__)
+    #define LOG_OS_WAIT_CLOCK   CLOCK_REALTIME
+#else
+    #define LOG_OS_WAIT_CLOCK   CLOCK_MONOTONIC
+#endif
+#endif
+
+// ----------------------------------------------------------------------------
+// Public functions
+// ----------------------------------------------------------------------------
+
+#if defined(__ZEPHYR__)
+
+void LogOs::CreateThread(LogOsThread_t &thread, LogOsStack_t* pStack, size_t stackSize,
+                         LogOsThreadEntry_t entry, int priority, void* pArg)
+{
+    k_thread_create(&thread, pStack, stackSize, entry, pArg, NULL, NULL, priority, 0, K_NO_WAIT);
+}
+
+void LogOs::InitializeSemaphore(LogOsSemaphore_t &semaphore)
+{
+    k_sem_init(&semaphore, 0, 1);
+}
+
+void LogOs::GiveSemaphore(LogOsSemaphore_t &semaphore)
+{
+    k_sem_give(&semaphore);
+}
+
+bool LogOs::TakeSemaphore(LogOsSemaphore_t &semaphore, uint32_t timeoutMs)
+{
+    k_timeout_t timeout = (timeoutMs == LOG_OS_WAIT_FOREVER) ? K_FOREVER : K_MSEC(timeoutMs);
+
+    return k_sem_take(&semaphore, timeout) == 0;
+}
+
+bool LogOs::CanBlock()
+{
+    return !k_is_in_isr() && k_is_preempt_thread();
+}
+
+uint32_t LogOs::GetTimeMs()
+{
+    return k_uptime_get_32();
+}
+
+uint32_t LogOs::GetCycleCount()
+{
+    return k_cycle_get_32();
+}
+
+uint32_t LogOs::CyclesToUs(uint32_t cycles)
+{
+    return k_cyc_to_us_floor32(cycles);
+}
+
+uint32_t LogOs::GetCpuId()
+{
+#if CONFIG_SMP
+    return arch_curr_cpu()->id;
+#else
+    return 0;
+#endif
+}
+
+#else // defined(__ZEPHYR__)
+
+void LogOs::CreateThread(LogOsThread_t &thread, LogOsStack_t* pStack, size_t stackSize,
+                         LogOsThreadEntry_t entry, int priority, void* pArg)
+{
+    UNUSED(pStack);
+    UNUSED(stackSize);
+    UNUSED(priority);
+
+    // The thread runs until the process exits, like a Zephyr thread which never returns
+    thread = std::thread(entry, pArg, nullptr, nullptr);
+    thread.detach();
+}
+
+void LogOs::InitializeSemaphore(LogOsSemaphore_t &semaphore)
+{
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+#if !defined(__APPLE__)
+    pthread_condattr_setclock(&attributes, LOG_OS_WAIT_CLOCK);
+#endif
+
+    pthread_mutex_init(&semaphore.mutex, NULL);
+    pthread_cond_init(&semaphore.condition, &attributes);
+    pthread_condattr_destroy(&attributes);
+    semaphore.signaled = false;
+}
+
+void LogOs::GiveSemaphore(LogOsSemaphore_t &semaphore)
+{
+    pthread_mutex_lock(&semaphore.mutex);
+    semaphore.signaled = true;
+    pthread_cond_signal(&semaphore.condition);
+    pthread_mutex_unlock(&semaphore.mutex);
+}
+
+bool LogOs::TakeSemaphore(LogOsSemaphore_t &semaphore, uint32_t timeoutMs)
+{
+    struct timespec deadline = {};
+
+    if (timeoutMs != LOG_OS_WAIT_FOREVER)
+    {
+        // The condition variable waits until an absolute time of its clock
+        clock_gettime(LOG_OS_WAIT_CLOCK, &deadline);
+        deadline.tv_sec += timeoutMs / 1000;
+        deadline.tv_nsec += static_cast<long>(timeoutMs % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&semaphore.mutex);
+
+    int rc = 0;
+    while (!semaphore.signaled && (rc == 0))
+    {
+        rc = (timeoutMs == LOG_OS_WAIT_FOREVER) ? pthread_cond_wait(&semaphore.condition, &semaphore.mutex) :
+                                                  pthread_cond_timedwait(&semaphore.condition, &semaphore.mutex, &deadline);
+    }
+
+    // The semaphore may be given right when the timeout expires
+    bool taken = semaphore.signaled;
+    semaphore.signaled = false;
+
+    pthread_mutex_unlock(&semaphore.mutex);
+
+    return taken;
+}
+
+bool LogOs::CanBlock()
+{
+    // Host builds have no ISR context
+    return true;
+}
+
+uint32_t LogOs::GetTimeMs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return static_cast<uint32_t>((static_cast<uint64_t>(now.tv_sec) * 1000U) + (static_cast<uint64_t>(now.tv_nsec) / 1000000U));
+}
+
+uint32_t LogOs::GetCycleCount()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    // The cycles of host builds are microseconds, so that a duration wraps around after 71 minutes and not 4 seconds
+    return static_cast<uint32_t>((static_cast<uint64_t>(now.tv_sec) * 1000000U) + (static_cast<uint64_t>(now.tv_nsec) / 1000U));
+}
+
+uint32_t LogOs::CyclesToUs(uint32_t cycles)
+{
+    return cycles;
+}
+
+uint32_t LogOs::GetCpuId()
+{
+#if defined(__linux__)
+    int cpuId = sched_getcpu();
+
+    return (cpuId < 0) ? 0 : static_cast<uint32_t>(cpuId);
+#else
+    return 0;
+#endif
+}
+
+#endif // defined(__ZEPHYR__)
@@ -9,8 +9,40 @@
 #include "LogCore.hpp"
 
 #include <cstdio>
+#include <errno.h>
 #include <pw_log_string/handler.h>
 
+// ----------------------------------------------------------------------------
+// Private function definitions
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Formats the log message into a stack buffer and hands it over to the logging core.
+ *
+ * It is kept out of line, so that the stack buffer is only allocated when the message
+ * cannot be formatted directly into the log queue.
+ *
+ * @param[in] level The log level of the message.
+ * @param[in] message The log message.
+ * @param[in] args The variable argument list.
+ * @param[in] pSource The origin of the message, or nullptr if unknown.
+ */
+static __attribute__((noinline)) void HandleFormattedMessage(int level, const char* message, va_list args, const LogSource_t* pSource)
+{
+    // Format the log message into the buffer
+    constexpr size_t cBufferSize = CONFIG_COMMONS_LOGGING_BUFFER_SIZE + 1;
+    uint8_t formattedMessage[cBufferSize];
+    size_t formattedMessageLength = vsnprintf(reinterpret_cast<char*>(formattedMessage), cBufferSize, message, args);
+    ASSERT(formattedMessageLength > 0 && formattedMessageLength < cBufferSize);
+
+    // Send the formatted log message
+    LogCore::HandleLogMessage(formattedMessage, formattedMessageLength, level, pSource);
+}
+
+// ----------------------------------------------------------------------------
+// Public function definitions
+// ----------------------------------------------------------------------------
+
 /**
  * @brief Implementation of the log message handler used as backend for pw_log_string.handler.
  *
@@ -32,19 +64,47 @@ void pw_log_string_HandleMessageVaList(int level,
                                        const char* message,
                                        va_list args)
 {
-    UNUSED(level);
-    UNUSED(flags);
     UNUSED(module_name);
     UNUSED(file_name);
-    UNUSED(line_number);
     ASSERT(message != NULL);
 
-    // Format the log message into the buffer
+    if (!LogCore::IsLevelEnabled(level))
+    {
+        // No consumer wants the log message, so skip formatting it
+        return;
+    }
+
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+    // The logging macros pass the name identifiers of the call site in the flags
+    LogSource_t source = { .moduleId = LOG_SOURCE_MODULE_ID(flags),
+                           .fileId   = LOG_SOURCE_FILE_ID(flags),
+                           .line     = static_cast<uint16_t>(line_number) };
+    const LogSource_t* pSource = &source;
+#else
+    UNUSED(flags);
+    UNUSED(line_number);
+    const LogSource_t* pSource = nullptr;
+#endif
+
+#if CONFIG_COMMONS_LOGGING_DEFERRED_FORMAT
+    // Queue the format string and the raw arguments, the log thread formats the log message
+    if (LogCore::HandleLogPackage(level, message, args, pSource) != -EAGAIN)
+    {
+        return;
+    }
+#elif CONFIG_COMMONS_LOGGING_DEFERRED
+    // Format the log message directly into the log queue
     constexpr size_t cBufferSize = CONFIG_COMMONS_LOGGING_BUFFER_SIZE + 1;
-    uint8_t formattedMessage[cBufferSize];
-    size_t formattedMessageLength = vsnprintf(reinterpret_cast<char*>(formattedMessage), cBufferSize, message, args);
-    ASSERT(formattedMessageLength > 0 && formattedMessageLength < cBufferSize);
+    uint8_t* pSlot = nullptr;
+    if (LogCore::ReserveLogMessage(pSlot, cBufferSize, level) == 0)
+    {
+        size_t formattedMessageLength = vsnprintf(reinterpret_cast<char*>(pSlot), cBufferSize, message, args);
+        ASSERT(formattedMessageLength > 0 && formattedMessageLength < cBufferSize);
 
-    // Send the formatted log message
-    LogCore::HandleLogMessage(formattedMessage, formattedMessageLength, level);
+        LogCore::CommitLogMessage(formattedMessageLength, level, pSource);
+        return;
+    }
+#endif // CONFIG_COMMONS_LOGGING_DEFERRED_FORMAT
+
+    HandleFormattedMessage(level, message, args, pSource);
 }
@@ -30,11 +30,20 @@
 
 // Provide module name and log level for the Pigweed logging system
 #define PW_LOG_MODULE_NAME          LOG_MODULE_NAME
-#define PW_LOG_LEVEL                MAP_CUSTOM_LOG_LEVEL_TO_PW(MODULE_LOG_LEVEL)
+#define PW_LOG_LEVEL                MAP_CUSTOM_LOG_LEVEL_TO_PW(LOG_COMPILED_LEVEL)
+
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+#include "LogSource.h"
+
+// The module and file name identifiers of the call site are passed to the handler in the flags
+#define LOG_FLAGS                   LogSource_GetFlags(&sLogSourceFlags, PW_LOG_MODULE_NAME, __FILE_NAME__)
+#else
+#define LOG_FLAGS                   PW_LOG_FLAGS
+#endif
 
 // Macro to pass the formatted log message to the Pigweed logging system
 #define LOG_MESSAGE(level, level_string, fmt, ...) \
-    PW_LOG(MAP_CUSTOM_LOG_LEVEL_TO_PW(level), PW_LOG_LEVEL, PW_LOG_MODULE_NAME, PW_LOG_FLAGS, LOG_FORMAT(level_string, PW_LOG_MODULE_NAME, __FILE_NAME__, LINE_STRING, fmt), ##__VA_ARGS__)
+    PW_LOG(MAP_CUSTOM_LOG_LEVEL_TO_PW(level), PW_LOG_LEVEL, PW_LOG_MODULE_NAME, LOG_FLAGS, LOG_FORMAT(level_string, PW_LOG_MODULE_NAME, __FILE_NAME__, LINE_STRING, fmt), ##__VA_ARGS__)
 
 // The PW_LOG_TOKENIZED_FORMAT_STRING macro is used by pigweed to append the module name to the tokenized message.
 // We re-define it to use the string received from the logging macros, without appending the anything to it.
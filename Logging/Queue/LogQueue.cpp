@@ -8,177 +8,1080 @@
 // Header includes
 // ----------------------------------------------------------------------------
 
+#include "CommonTypes.h"
 #include "LogQueue.hpp"
 #include "Assert.h"
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    #include "LogTimestamp.h"
+#endif
 
 #include <algorithm>
+#include <cstring>
+
+#if CONFIG_COMMONS_LOGGING_QUEUE_MPSC && CONFIG_COMMONS_LOGGING_OVERFLOW
+    #error "CONFIG_COMMONS_LOGGING_OVERFLOW is not supported with CONFIG_COMMONS_LOGGING_QUEUE_MPSC"
+#endif
 
 // ----------------------------------------------------------------------------
 // Macro definitions
 // ----------------------------------------------------------------------------
 
-#define LOG_METADATA_SIGNATURE 0xDEADBEEF
+// Only multiple log queues are merged by sequence number, a single log queue is already in order
+#if CONFIG_COMMONS_LOGGING_QUEUE_PER_CPU || CONFIG_COMMONS_LOGGING_QUEUE_PER_THREAD || CONFIG_COMMONS_LOGGING_PRIORITY_LANE
+    #define LOG_HEADER_SEQUENCE_NUMBER  1
+#else
+    #define LOG_HEADER_SEQUENCE_NUMBER  0
+#endif
+
+// Without a single producer, a producer does not know the previous log message of the queue.
+// So the timestamps are relative to the queue initialization instead of the previous log message.
+#if CONFIG_COMMONS_LOGGING_QUEUE_MPSC || CONFIG_COMMONS_LOGGING_OVERFLOW
+    #define LOG_HEADER_TIMESTAMP_OFFSET 1
+#else
+    #define LOG_HEADER_TIMESTAMP_OFFSET 0
+#endif
+
+// The first byte of the header holds the commit flag, the level and reserved bits which are always zero.
+// The commit flag is always set, so that a zero byte is a log message which is not written yet.
+#define LOG_HEADER_COMMIT_FLAG      0x80
+#define LOG_HEADER_LEVEL_SHIFT      3
+#define LOG_HEADER_LEVEL_MASK       0x0F
+#define LOG_HEADER_RESERVED_MASK    0x07
+
+// Level of the records used to skip the unused bytes at the end of the buffer
+#define LOG_PADDING_LEVEL           LOG_HEADER_LEVEL_MASK
+static_assert(LogQueue::cLevelCount == (LOG_HEADER_LEVEL_MASK + 1), "Every queued level must have a drop counter");
+
+// The length and the timestamp are base 128 varints, a 32 bit value takes at most 5 bytes and a 64 bit value 10 bytes
+#define LOG_HEADER_MAX_LENGTH_SIZE      5
+#define LOG_HEADER_MAX_TIMESTAMP_SIZE   10
+
+// Polynomial of the CRC-8 covering the header
+#define LOG_HEADER_CRC_POLYNOMIAL   0x07
 
 // ----------------------------------------------------------------------------
 // Datatype definitions
 // ----------------------------------------------------------------------------
 
-typedef struct __attribute__((packed)) LogMetadata
+/*
+ * Decoded record header.
+ *
+ * In the queue, the header is encoded as:
+ *  - 1 byte: commit flag, level and reserved bits
+ *  - 1 to 5 bytes: length of the log message, as a base 128 varint
+ *  - 1 to 10 bytes: timestamp of the log message, as a base 128 varint, only with CONFIG_COMMONS_LOGGING_TIMESTAMP
+ *  - 2 bytes: low bits of the sequence number, only with multiple log queues
+ *  - 6 bytes: module, file and line of the log message, only with CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+ *  - 1 byte: CRC-8 of the previous bytes, only with CONFIG_COMMONS_LOGGING_QUEUE_HEADER_CHECKSUM
+ */
+typedef struct
 {
-    uint32_t    signature;          // Signature for identifying valid log message
-    uint32_t    sequenceNumber;     // Sequence number for the log message
     uint32_t    length;             // Length of the log message
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    uint64_t    timestamp;          // Time since the previous log message of the queue, or since the queue initialization
+#endif
+#if LOG_HEADER_SEQUENCE_NUMBER
+    uint16_t    sequenceNumber;     // Low bits of the sequence number for the log message
+#endif
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+    LogSource_t source;             // Module, file and line of the log message
+#endif
     uint8_t     level;              // Log level
 } LogMetadata_t;
 
+// Size of the fixed size header fields
+static constexpr size_t cLogHeaderFieldsSize = (LOG_HEADER_SEQUENCE_NUMBER ? sizeof(uint16_t) : 0)
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+                                             + sizeof(LogSource_t)
+#endif
+#if CONFIG_COMMONS_LOGGING_QUEUE_HEADER_CHECKSUM
+                                             + sizeof(uint8_t)
+#endif
+                                             ;
+
+// Smallest and largest sizes of the varints of an encoded header
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+static constexpr size_t cLogHeaderMinVarintsSize = 1 + 1;
+static constexpr size_t cLogHeaderMaxVarintsSize = LOG_HEADER_MAX_LENGTH_SIZE + LOG_HEADER_MAX_TIMESTAMP_SIZE;
+#else
+static constexpr size_t cLogHeaderMinVarintsSize = 1;
+static constexpr size_t cLogHeaderMaxVarintsSize = LOG_HEADER_MAX_LENGTH_SIZE;
+#endif
+
+// Smallest and largest sizes of an encoded header
+static constexpr size_t cLogHeaderMinSize = 1 + cLogHeaderMinVarintsSize + cLogHeaderFieldsSize;
+static constexpr size_t cLogHeaderMaxSize = 1 + cLogHeaderMaxVarintsSize + cLogHeaderFieldsSize;
+
 // ----------------------------------------------------------------------------
-// Variable definitions
+// Private functions
 // ----------------------------------------------------------------------------
 
-LogQueue_t LogQueue::mLogQueue;
-uint8_t LogQueue::mMessageBuffer[cLogMessageBufferSize + 1];
-uint32_t LogQueue::mSequenceNumber = 0;
+/**
+ * @brief Gets the number of bytes of a value encoded as a varint.
+ *
+ * @param[in] value The value to encode.
+ *
+ * @return size_t Number of bytes of the varint.
+ */
+static size_t GetVarintSize(uint64_t value)
+{
+    size_t varintSize = 1;
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        ++varintSize;
+    }
+
+    return varintSize;
+}
+
+/**
+ * @brief Encodes a value as a varint, padded with continuation bytes up to the given size.
+ *
+ * @param[out] pData Pointer to the buffer receiving the varint.
+ * @param[in] value The value to encode.
+ * @param[in] varintSize Number of bytes of the varint, at least GetVarintSize(value).
+ *
+ * @return size_t Number of bytes of the varint.
+ */
+static size_t EncodeVarint(uint8_t* pData, uint64_t value, size_t varintSize)
+{
+    for (size_t i = 1; i < varintSize; ++i)
+    {
+        *pData++ = static_cast<uint8_t>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    *pData = static_cast<uint8_t>(value);
+
+    return varintSize;
+}
+
+/**
+ * @brief Decodes a varint.
+ *
+ * @param[in] pData Pointer to the varint.
+ * @param[in] length Number of bytes available.
+ * @param[in] maxVarintSize Maximum number of bytes of the varint.
+ * @param[out] value The decoded value.
+ *
+ * @return size_t Number of bytes of the varint, or 0 if it is invalid.
+ */
+static size_t DecodeVarint(const uint8_t* pData, size_t length, size_t maxVarintSize, uint64_t& value)
+{
+    value = 0;
+
+    for (size_t i = 0; (i < length) && (i < maxVarintSize); ++i)
+    {
+        value |= static_cast<uint64_t>(pData[i] & 0x7F) << (7 * i);
+        if ((pData[i] & 0x80) == 0)
+        {
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+#if CONFIG_COMMONS_LOGGING_QUEUE_HEADER_CHECKSUM
+/**
+ * @brief Computes the CRC-8 of the header bytes.
+ *
+ * @param[in] pData Pointer to the header bytes.
+ * @param[in] length Number of header bytes.
+ *
+ * @return uint8_t The CRC-8 of the bytes.
+ */
+static uint8_t ComputeChecksum(const uint8_t* pData, size_t length)
+{
+    uint8_t crc = 0;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        crc ^= pData[i];
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ LOG_HEADER_CRC_POLYNOMIAL) : static_cast<uint8_t>(crc << 1);
+        }
+    }
+
+    return crc;
+}
+#endif
+
+/**
+ * @brief Gets the size of an encoded record header.
+ *
+ * @param[in] metadata The header to encode.
+ * @param[in] lengthSize Number of bytes of the length, at least GetVarintSize(metadata.length).
+ *
+ * @return size_t Size of the encoded header.
+ */
+static size_t GetHeaderSize(const LogMetadata_t& metadata, size_t lengthSize)
+{
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    return 1 + lengthSize + GetVarintSize(metadata.timestamp) + cLogHeaderFieldsSize;
+#else
+    UNUSED(metadata);
+
+    return 1 + lengthSize + cLogHeaderFieldsSize;
+#endif
+}
+
+/**
+ * @brief Encodes a record header.
+ *
+ * The length may be encoded with more bytes than needed, so that the size of the header
+ * is known before the length of the log message.
+ *
+ * @param[out] pHeader Pointer to the buffer receiving the header, at least cLogHeaderMaxSize bytes.
+ * @param[in] metadata The header to encode.
+ * @param[in] lengthSize Number of bytes of the length, at least GetVarintSize(metadata.length).
+ *
+ * @return size_t Size of the encoded header.
+ */
+static size_t EncodeHeader(uint8_t* pHeader, const LogMetadata_t& metadata, size_t lengthSize)
+{
+    ASSERT(metadata.level <= LOG_HEADER_LEVEL_MASK);
+    ASSERT((lengthSize >= GetVarintSize(metadata.length)) && (lengthSize <= LOG_HEADER_MAX_LENGTH_SIZE));
+
+    size_t headerSize = 0;
+    pHeader[headerSize++] = static_cast<uint8_t>(LOG_HEADER_COMMIT_FLAG | (metadata.level << LOG_HEADER_LEVEL_SHIFT));
+    headerSize += EncodeVarint(&pHeader[headerSize], metadata.length, lengthSize);
+
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    headerSize += EncodeVarint(&pHeader[headerSize], metadata.timestamp, GetVarintSize(metadata.timestamp));
+#endif
+
+#if LOG_HEADER_SEQUENCE_NUMBER
+    memcpy(&pHeader[headerSize], &metadata.sequenceNumber, sizeof(metadata.sequenceNumber));
+    headerSize += sizeof(metadata.sequenceNumber);
+#endif
+
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+    memcpy(&pHeader[headerSize], &metadata.source, sizeof(metadata.source));
+    headerSize += sizeof(metadata.source);
+#endif
+
+#if CONFIG_COMMONS_LOGGING_QUEUE_HEADER_CHECKSUM
+    pHeader[headerSize] = ComputeChecksum(pHeader, headerSize);
+    headerSize += sizeof(uint8_t);
+#endif
+
+    return headerSize;
+}
+
+/**
+ * @brief Decodes a record header.
+ *
+ * @param[in] pHeader Pointer to the queued bytes starting with the header.
+ * @param[in] length Number of queued bytes, the header may be shorter.
+ * @param[out] metadata The decoded header.
+ *
+ * @return size_t Size of the header, or 0 if the header is invalid.
+ */
+static size_t DecodeHeader(const uint8_t* pHeader, size_t length, LogMetadata_t& metadata)
+{
+    if ((length < cLogHeaderMinSize) ||
+        ((pHeader[0] & (LOG_HEADER_COMMIT_FLAG | LOG_HEADER_RESERVED_MASK)) != LOG_HEADER_COMMIT_FLAG))
+    {
+        return 0;
+    }
+
+    size_t headerSize = 1;
+    metadata.level = (pHeader[0] >> LOG_HEADER_LEVEL_SHIFT) & LOG_HEADER_LEVEL_MASK;
+
+    uint64_t value;
+    size_t varintSize = DecodeVarint(&pHeader[headerSize], length - headerSize, LOG_HEADER_MAX_LENGTH_SIZE, value);
+    if ((varintSize == 0) || (value > UINT32_MAX))
+    {
+        return 0;
+    }
+    metadata.length = static_cast<uint32_t>(value);
+    headerSize += varintSize;
+
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    varintSize = DecodeVarint(&pHeader[headerSize], length - headerSize, LOG_HEADER_MAX_TIMESTAMP_SIZE, metadata.timestamp);
+    if (varintSize == 0)
+    {
+        return 0;
+    }
+    headerSize += varintSize;
+#endif
+
+    if ((headerSize + cLogHeaderFieldsSize) > length)
+    {
+        return 0;
+    }
+
+#if LOG_HEADER_SEQUENCE_NUMBER
+    memcpy(&metadata.sequenceNumber, &pHeader[headerSize], sizeof(metadata.sequenceNumber));
+    headerSize += sizeof(metadata.sequenceNumber);
+#endif
+
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+    memcpy(&metadata.source, &pHeader[headerSize], sizeof(metadata.source));
+    headerSize += sizeof(metadata.source);
+#endif
+
+#if CONFIG_COMMONS_LOGGING_QUEUE_HEADER_CHECKSUM
+    if (pHeader[headerSize] != ComputeChecksum(pHeader, headerSize))
+    {
+        return 0;
+    }
+    headerSize += sizeof(uint8_t);
+#endif
+
+    return headerSize;
+}
 
 // ----------------------------------------------------------------------------
 // Public functions
 // ----------------------------------------------------------------------------
 
-void LogQueue::Initialize(void* pBuffer, size_t size)
+void LogQueue::Initialize(void* pBuffer, size_t size, size_t cursorCount)
 {
     ASSERT(pBuffer != NULL);
-    ASSERT(size > sizeof(LogMetadata_t));
+    ASSERT(size > cLogHeaderMaxSize);
+    ASSERT((cursorCount > 0) && (cursorCount <= cCursorCount));
+
+    // Use the largest power of two that fits in the buffer, so that the indexes can be masked
+    size_t queueSize = 1;
+    while (queueSize <= (size / 2))
+    {
+        queueSize *= 2;
+    }
+    ASSERT(queueSize > cLogHeaderMaxSize);
+
+    mLogQueue.pBuffer = static_cast<uint8_t*>(pBuffer);
+    mLogQueue.size = queueSize;
+    mLogQueue.mask = queueSize - 1;
+    mLogQueue.head.store(0, std::memory_order_relaxed);
+
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    mTimestampEpoch = LogTimestamp_Get();
+#if !LOG_HEADER_TIMESTAMP_OFFSET
+    mLastTimestamp = mTimestampEpoch;
+#endif
+#endif
+
+    // All the cursors start at the head
+    mCursorCount = cursorCount;
+    for (size_t i = 0; i < cCursorCount; ++i)
+    {
+        LogCursor_t &readCursor = mCursors[i];
+        readCursor.readIndex = 0;
+        readCursor.lastPeekIndex = 0;
+        readCursor.releasedIndex.store(0, std::memory_order_relaxed);
+#if CONFIG_COMMONS_LOGGING_OVERFLOW
+        readCursor.holding.store(false, std::memory_order_relaxed);
+#endif
+#if !LOG_HEADER_SEQUENCE_NUMBER
+        readCursor.readSequenceNumber = 0;
+#endif
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP && !LOG_HEADER_TIMESTAMP_OFFSET
+        readCursor.readTimestamp = mTimestampEpoch;
+        readCursor.lastPeekTimestamp = mTimestampEpoch;
+#endif
+    }
 
-    mLogQueue.pBuffer = pBuffer;
-    mLogQueue.size = size;
-    mLogQueue.head = 0;
-    mLogQueue.tail = 0;
+#if CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+    // Start without any committed header in the buffer
+    ClearQueue(0, queueSize);
+#else
+    mReservedLength = 0;
+#endif
+
+    mLogQueue.tail.store(0, std::memory_order_release);
 }
 
-int LogQueue::PushLog(const uint8_t* pMessage, size_t messageLength, int level)
+int LogQueue::PushLog(const uint8_t* pMessage, size_t messageLength, int level, const LogSource_t* pSource)
 {
+#if !CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+    UNUSED(pSource);
+#endif
     ASSERT(pMessage != NULL);
     ASSERT(messageLength > 0);
+    ASSERT((level >= 0) && (level < LOG_PADDING_LEVEL));
+    ASSERT(mLogQueue.pBuffer != NULL);
+
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    uint64_t timestamp = LogTimestamp_Get();
+#endif
+
+    // Truncate the message to the size the consumer can handle and the queue can hold
+    size_t messageLengthToCopy = std::min({ messageLength,
+                                            cLogMessageBufferSize,
+                                            mLogQueue.size - cLogHeaderMaxSize });
+
+    // Create the header of the log message, the sequence number is only taken once the space is claimed
+    LogMetadata_t metadata = { .length         = static_cast<uint32_t>(messageLengthToCopy),
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+                               .timestamp      = GetTimestampDelta(timestamp),
+#endif
+#if LOG_HEADER_SEQUENCE_NUMBER
+                               .sequenceNumber = 0,
+#endif
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+                               .source         = (pSource != nullptr) ? *pSource : LogSource_t{},
+#endif
+                               .level          = static_cast<uint8_t>(level) };
+    size_t lengthSize = GetVarintSize(messageLengthToCopy);
+    size_t headerSize = GetHeaderSize(metadata, lengthSize);
+    size_t totalMessageLength = headerSize + messageLengthToCopy;
+
+    size_t tail = mLogQueue.tail.load(std::memory_order_relaxed);
+
+#if CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+    // Claim the space by moving the tail, the producers racing for it retry with the updated tail.
+    // The producer is counted before claiming, so that the consumer knows when all claimed space is written.
+    mWriterCount.fetch_add(1, std::memory_order_seq_cst);
+    do
+    {
+        if (!HasSpace(tail, totalMessageLength))
+        {
+            mWriterCount.fetch_sub(1, std::memory_order_relaxed);
+            return -ENOBUFS;
+        }
+    } while (!mLogQueue.tail.compare_exchange_weak(tail, tail + totalMessageLength, std::memory_order_seq_cst, std::memory_order_relaxed));
+#else
+    ASSERT(mReservedLength == 0);
+
+    // Only the producer writes the tail, check if enough space is available in the log buffer
+    if (!HasSpace(tail, totalMessageLength))
+    {
+        return -ENOBUFS;
+    }
+#endif
+
+#if LOG_HEADER_SEQUENCE_NUMBER
+    metadata.sequenceNumber = static_cast<uint16_t>(mSequenceNumber.fetch_add(1, std::memory_order_relaxed));
+#endif
+    uint8_t header[cLogHeaderMaxSize];
+    EncodeHeader(header, metadata, lengthSize);
+
+    // Copy the log message to the log buffer
+    CopyToQueue(tail + headerSize, pMessage, messageLengthToCopy);
+
+#if CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+    // Copy the header without its first byte, then publish the message to the consumer by writing the commit flag
+    CopyToQueue(tail + 1, &header[1], headerSize - 1);
+    __atomic_store_n(&mLogQueue.pBuffer[tail & mLogQueue.mask], header[0], __ATOMIC_RELEASE);
+    mWriterCount.fetch_sub(1, std::memory_order_release);
+#else
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP && !LOG_HEADER_TIMESTAMP_OFFSET
+    mLastTimestamp = timestamp;
+#endif
+
+    // Copy the header and publish the message to the consumer
+    CopyToQueue(tail, header, headerSize);
+    mLogQueue.tail.store(tail + totalMessageLength, std::memory_order_release);
+#endif
 
-    uint8_t* pQueueBuffer = static_cast<uint8_t*>(mLogQueue.pBuffer);
-    size_t queueSize = mLogQueue.size;
-    size_t head = mLogQueue.head;
-    size_t &tail = mLogQueue.tail;
+    return 0;
+}
 
-    ASSERT(pQueueBuffer != NULL);
-    ASSERT(queueSize > sizeof(LogMetadata_t));
+#if !CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+uint8_t* LogQueue::Reserve(size_t maxLength)
+{
+    ASSERT(maxLength > 0);
+    ASSERT(mLogQueue.pBuffer != NULL);
+    ASSERT(mReservedLength == 0);
 
-    size_t totalMessageLength = std::min(messageLength + sizeof(LogMetadata_t), queueSize - 1);
-    if (totalMessageLength > queueSize)
+    // A slot larger than the whole queue never fits, the log message is queued by copy and truncated instead
+    if (maxLength > (mLogQueue.size - cLogHeaderMaxSize))
     {
-        // Message is too large to fit in the buffer even when empty
-        return -EMSGSIZE;
+        return nullptr;
     }
 
-    // Check if enough space is available in the log buffer
-    size_t availableSpace = 0;
-    if (tail >= head)
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    // The timestamp is taken now, so that its size is known along with the size of the header
+    mReservedTimestamp = LogTimestamp_Get();
+#endif
+
+    // Only the producer writes the tail
+    size_t tail = mLogQueue.tail.load(std::memory_order_relaxed);
+
+    // The length is encoded with as many bytes as the maximum length needs, so the header size is known now
+    LogMetadata_t metadata = { .length         = 0,
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+                               .timestamp      = GetTimestampDelta(mReservedTimestamp),
+#endif
+#if LOG_HEADER_SEQUENCE_NUMBER
+                               .sequenceNumber = 0,
+#endif
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+                               .source         = {},
+#endif
+                               .level          = 0 };
+    size_t headerSize = GetHeaderSize(metadata, GetVarintSize(maxLength));
+
+    // The header may wrap, but the slot must be contiguous. Otherwise skip to the start of the buffer.
+    size_t paddingLength = 0;
+    if (((tail + headerSize) & mLogQueue.mask) + maxLength > mLogQueue.size)
     {
-        // Normal case: If tail is ahead of head, available space is total space - used space
-        availableSpace = queueSize - (tail - head);
+        paddingLength = mLogQueue.size - (tail & mLogQueue.mask);
     }
-    else
+
+    if (!HasSpace(tail, paddingLength + headerSize + maxLength))
     {
-        // Wrap around case: If tail is behind head, available space is from tail to head
-        availableSpace = head - tail;
+        return nullptr;
     }
 
-    if (totalMessageLength > availableSpace)
+    if (paddingLength > 0)
     {
-    #if CONFIG_COMMONS_LOGGING_OVERFLOW
-        // Not enough space, drop oldest messages
-        mLogQueue.head = tail;
-    #else
-        return -ENOBUFS;
-    #endif
+        // The padding is published together with the reserved record on commit
+        LogMetadata_t paddingMetadata = { .length         = 0,
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+                                          .timestamp      = 0,
+#endif
+#if LOG_HEADER_SEQUENCE_NUMBER
+                                          .sequenceNumber = 0,
+#endif
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+                                          .source         = {},
+#endif
+                                          .level          = LOG_PADDING_LEVEL };
+
+        // The padding is at least as long as the reserved header, so a length size always fits
+        size_t lengthSize = 1;
+        while (GetVarintSize(paddingLength - GetHeaderSize(paddingMetadata, lengthSize)) > lengthSize)
+        {
+            ++lengthSize;
+        }
+        paddingMetadata.length = static_cast<uint32_t>(paddingLength - GetHeaderSize(paddingMetadata, lengthSize));
+
+        uint8_t header[cLogHeaderMaxSize];
+        CopyToQueue(tail, header, EncodeHeader(header, paddingMetadata, lengthSize));
     }
 
-    // Create metadata for the log message
-    uint32_t messageLengthToCopy = static_cast<uint32_t>(totalMessageLength - sizeof(LogMetadata_t));
-    LogMetadata_t metadata = { .signature      = LOG_METADATA_SIGNATURE,
-                               .sequenceNumber = mSequenceNumber++ % UINT32_MAX,
-                               .length         = messageLengthToCopy,
+    mReservedIndex = tail + paddingLength;
+    mReservedLength = maxLength;
+
+    return &mLogQueue.pBuffer[(mReservedIndex + headerSize) & mLogQueue.mask];
+}
+
+void LogQueue::Commit(size_t messageLength, int level, const LogSource_t* pSource)
+{
+#if !CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+    UNUSED(pSource);
+#endif
+    ASSERT(mReservedLength > 0);
+    ASSERT(messageLength <= mReservedLength);
+    ASSERT((level >= 0) && (level < LOG_PADDING_LEVEL));
+
+    size_t reservedLength = mReservedLength;
+    mReservedLength = 0;
+
+    if (messageLength == 0)
+    {
+        // Nothing was written, abandon the reservation along with its padding
+        return;
+    }
+
+    // Create the header of the log message, with the length size chosen on reserve
+    size_t messageLengthToCommit = std::min(messageLength, cLogMessageBufferSize);
+    LogMetadata_t metadata = { .length         = static_cast<uint32_t>(messageLengthToCommit),
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+                               .timestamp      = GetTimestampDelta(mReservedTimestamp),
+#endif
+#if LOG_HEADER_SEQUENCE_NUMBER
+                               .sequenceNumber = static_cast<uint16_t>(mSequenceNumber.fetch_add(1, std::memory_order_relaxed)),
+#endif
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+                               .source         = (pSource != nullptr) ? *pSource : LogSource_t{},
+#endif
                                .level          = static_cast<uint8_t>(level) };
+    uint8_t header[cLogHeaderMaxSize];
+    size_t headerSize = EncodeHeader(header, metadata, GetVarintSize(reservedLength));
+    CopyToQueue(mReservedIndex, header, headerSize);
+
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP && !LOG_HEADER_TIMESTAMP_OFFSET
+    mLastTimestamp = mReservedTimestamp;
+#endif
+
+    // Publish the padding, if any, and the message to the consumer
+    mLogQueue.tail.store(mReservedIndex + headerSize + messageLengthToCommit, std::memory_order_release);
+}
+#endif // !CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+
+int LogQueue::PeekLog(LogRecord_t &record, size_t cursor)
+{
+    ASSERT(mLogQueue.pBuffer != NULL);
+    ASSERT(cursor < mCursorCount);
 
-    // Copy the metadata to the log buffer
-    for (size_t i = 0; i < sizeof(LogMetadata_t); ++i)
+    LogCursor_t &readCursor = mCursors[cursor];
+    LogMetadata_t metadata;
+
+#if CONFIG_COMMONS_LOGGING_OVERFLOW
+    // The producer drops the oldest messages to make room, except the ones held by the cursor
+    if (!readCursor.holding.load(std::memory_order_relaxed) && !HoldLogs(readCursor))
     {
-        static_cast<uint8_t*>(pQueueBuffer)[tail] = reinterpret_cast<uint8_t*>(&metadata)[i];
-        tail = (tail + 1) % queueSize;      // Wrap around if needed
+        return -ENODATA;
     }
 
-    // Copy the log message to the log buffer
-    for (size_t i = 0; i < messageLengthToCopy; ++i)
+    // The tail is published by the producer
+    size_t tail = mLogQueue.tail.load(std::memory_order_acquire);
+#else
+    // The tail is published by the producer
+    size_t head = mLogQueue.head.load(std::memory_order_acquire);
+    size_t tail = mLogQueue.tail.load(std::memory_order_acquire);
+
+    if ((tail - readCursor.readIndex) > (tail - head))
     {
-        static_cast<uint8_t*>(pQueueBuffer)[tail] = pMessage[i];
-        tail = (tail + 1) % queueSize;      // Wrap around if needed
+        // The producer dropped the messages under the read index to make room
+        readCursor.readIndex = head;
     }
+#endif
+
+    do
+    {
+        // Check if the buffer has data to read
+        if (readCursor.readIndex == tail)
+        {
+            return -ENODATA; // No data available
+        }
+
+    #if CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+        // Stop at the first log message which is claimed, but not yet written by its producer
+        uint8_t firstByte = __atomic_load_n(&mLogQueue.pBuffer[readCursor.readIndex & mLogQueue.mask], __ATOMIC_ACQUIRE);
+        if ((firstByte & LOG_HEADER_COMMIT_FLAG) == 0)
+        {
+            return -ENODATA;
+        }
+    #endif
+
+        // Read the header from the queue buffer
+        size_t availableData = tail - readCursor.readIndex;
+        uint8_t header[cLogHeaderMaxSize];
+    #if CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+        size_t headerLength = CopyHeaderFromQueue(readCursor.readIndex, availableData, header);
+    #else
+        // The bytes following the header are ignored
+        size_t headerLength = std::min(availableData, sizeof(header));
+        CopyFromQueue(readCursor.readIndex, header, headerLength);
+    #endif
+        size_t headerSize = DecodeHeader(header, headerLength, metadata);
+
+        if ((headerSize == 0) ||
+            (metadata.length > (availableData - headerSize)) ||
+            ((metadata.level != LOG_PADDING_LEVEL) && (metadata.length > cLogMessageBufferSize)))
+        {
+#if CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+            // Invalid log message of unknown length, the queued data is skipped up to the tail only once no
+            // producer is writing below it. Otherwise the read index is kept and the resync is retried later,
+            // so that no claimed space is released, and cleared, while its producer writes it.
+            size_t resyncIndex = mLogQueue.tail.load(std::memory_order_seq_cst);
+            if (mWriterCount.load(std::memory_order_seq_cst) == 0)
+            {
+                readCursor.readIndex = resyncIndex;
+            }
+#else
+            // Invalid log message, skip the queued data to resynchronize with the producer
+            readCursor.readIndex = tail;
+#endif
+            return -EBADMSG;
+        }
+
+        readCursor.lastPeekIndex = readCursor.readIndex;
+        readCursor.readIndex += headerSize + metadata.length;
+
+        // Padding records only skip the unused bytes at the end of the buffer
+    } while (metadata.level == LOG_PADDING_LEVEL);
+
+    // The message ends at the read index and is split at the end of the buffer, if needed
+    size_t offset = (readCursor.readIndex - metadata.length) & mLogQueue.mask;
+    size_t firstLength = std::min(static_cast<size_t>(metadata.length), mLogQueue.size - offset);
+
+    record.segments[0] = { .pData = &mLogQueue.pBuffer[offset], .length = firstLength };
+    record.segments[1] = { .pData = mLogQueue.pBuffer,          .length = metadata.length - firstLength };
+    record.segmentCount = (firstLength < metadata.length) ? 2 : 1;
+    record.level = metadata.level;
+#if LOG_HEADER_SEQUENCE_NUMBER
+    // Only the low bits are queued. The message took its sequence number before the current value of
+    // the counter, so the full number is recovered while less than 65536 messages were logged since.
+    uint32_t sequenceNumber = mSequenceNumber.load(std::memory_order_relaxed);
+    record.sequenceNumber = sequenceNumber - static_cast<uint16_t>(static_cast<uint16_t>(sequenceNumber) - metadata.sequenceNumber);
+#else
+    // A single log queue is already in order, the messages are numbered as they are peeked
+    record.sequenceNumber = readCursor.readSequenceNumber++;
+#endif
+#if CONFIG_COMMONS_LOGGING_STRUCTURED_PREFIX
+    record.source = metadata.source;
+#endif
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+#if LOG_HEADER_TIMESTAMP_OFFSET
+    record.timestamp = mTimestampEpoch + metadata.timestamp;
+#else
+    // Every log message is timed relative to the previous one
+    readCursor.lastPeekTimestamp = readCursor.readTimestamp;
+    readCursor.readTimestamp += metadata.timestamp;
+    record.timestamp = readCursor.readTimestamp;
+#endif
+#endif
 
     return 0;
 }
 
-int LogQueue::PullLog(uint8_t* &pMessage, size_t &messageLength, int &level)
+void LogQueue::UnpeekLog(size_t cursor)
 {
-    uint8_t* pQueueBuffer = static_cast<uint8_t*>(mLogQueue.pBuffer);
-    size_t queueSize = mLogQueue.size;
-    size_t &head = mLogQueue.head;
-    size_t tail = mLogQueue.tail;
+    ASSERT(cursor < mCursorCount);
 
-    ASSERT(pQueueBuffer != NULL);
-    ASSERT(queueSize > sizeof(LogMetadata_t));
+    LogCursor_t &readCursor = mCursors[cursor];
+    readCursor.readIndex = readCursor.lastPeekIndex;
+#if !LOG_HEADER_SEQUENCE_NUMBER
+    --readCursor.readSequenceNumber;
+#endif
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP && !LOG_HEADER_TIMESTAMP_OFFSET
+    readCursor.readTimestamp = readCursor.lastPeekTimestamp;
+#endif
+}
 
-    // Check if the buffer has data to read
-    if (head == tail)
+void LogQueue::CountDroppedLog(int level)
+{
+    ASSERT((level >= 0) && (static_cast<size_t>(level) < cLevelCount));
+
+    // None of the consumers will see the log message
+    for (size_t i = 0; i < cCursorCount; ++i)
     {
-        return -ENODATA; // No data available
+        mDroppedCounts[i][level].fetch_add(1, std::memory_order_relaxed);
     }
+#if CONFIG_COMMONS_LOGGING_STATS
+    mTotalDroppedCounts[level].fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+uint32_t LogQueue::TakeDroppedLogs(uint32_t (&counts)[cLevelCount], size_t cursor)
+{
+    ASSERT(cursor < cCursorCount);
+
+    uint32_t droppedCount = 0;
 
-    size_t availableData = 0;
-    if (head <= tail)
+    for (size_t i = 0; i < cLevelCount; ++i)
     {
-        // Normal case: If head is behind tail, available data is from head to tail
-        availableData = tail - head;
+        // Only write the counters which changed, the check is a plain load
+        counts[i] = 0;
+        if (mDroppedCounts[cursor][i].load(std::memory_order_relaxed) != 0)
+        {
+            counts[i] = mDroppedCounts[cursor][i].exchange(0, std::memory_order_relaxed);
+            droppedCount += counts[i];
+        }
     }
-    else
+
+    return droppedCount;
+}
+
+#if CONFIG_COMMONS_LOGGING_STATS
+void LogQueue::GetTotalDroppedLogs(uint32_t (&counts)[cLevelCount])
+{
+    for (size_t i = 0; i < cLevelCount; ++i)
     {
-        // Wrap around case: If head is ahead of tail, available data is total space - free space
-        availableData = queueSize - (head - tail);
+        counts[i] = mTotalDroppedCounts[i].load(std::memory_order_relaxed);
     }
+}
+#endif
+
+void LogQueue::ReleaseLogs(size_t cursor)
+{
+    ASSERT(cursor < mCursorCount);
 
-    if (availableData < sizeof(LogMetadata_t))
+    mCursors[cursor].releasedIndex.store(mCursors[cursor].readIndex, std::memory_order_relaxed);
+
+#if CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS
+    // The head follows the slowest cursor. Only one consumer moves it at a time, the others leave
+    // a request, so that the consumer moving the head takes their release into account too.
+    mHeadUpdateRequested.store(true);
+    while (mHeadUpdateRequested.load() && !mHeadUpdateInProgress.exchange(true))
     {
-        return -EBADMSG; // Not enough data to read metadata
+        // Taking the request also makes the released index of the requesting cursor visible
+        mHeadUpdateRequested.exchange(false);
+
+        size_t head = mLogQueue.head.load(std::memory_order_relaxed);
+        size_t slowestDistance = SIZE_MAX;
+        for (size_t i = 0; i < mCursorCount; ++i)
+        {
+            // A released index behind the head was already released by every cursor
+            size_t distance = mCursors[i].releasedIndex.load(std::memory_order_relaxed) - head;
+            slowestDistance = std::min(slowestDistance, (distance <= mLogQueue.size) ? distance : 0);
+        }
+
+        MoveHead(head + slowestDistance);
+
+        mHeadUpdateInProgress.store(false);
     }
+#else
+    MoveHead(mCursors[cursor].readIndex);
+#endif
 
-    // Read the metadata from the queue buffer
-    LogMetadata_t metadata;
-    for (size_t i = 0; i < sizeof(LogMetadata_t); ++i)
+#if CONFIG_COMMONS_LOGGING_OVERFLOW
+    // The producer may drop the unread messages again
+    mCursors[cursor].holding.store(false, std::memory_order_release);
+#endif
+}
+
+#if CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS
+size_t LogQueue::SkipLogs(size_t cursor, size_t maxLagSize)
+{
+    ASSERT(cursor < mCursorCount);
+
+    LogCursor_t &readCursor = mCursors[cursor];
+    LogRecord_t record;
+    size_t skippedCount = 0;
+
+    while (((mLogQueue.tail.load(std::memory_order_acquire) - readCursor.readIndex) > maxLagSize) &&
+           (PeekLog(record, cursor) == 0))
     {
-        reinterpret_cast<uint8_t*>(&metadata)[i] = static_cast<uint8_t*>(pQueueBuffer)[head];
-        head = (head + 1) % queueSize;      // Wrap around if needed
+        // Only this consumer misses the log message, the others still hand it over
+        mDroppedCounts[cursor][record.level].fetch_add(1, std::memory_order_relaxed);
+        ++skippedCount;
     }
 
-    if (metadata.signature != LOG_METADATA_SIGNATURE)
+    if (skippedCount > 0)
     {
-        return -EBADMSG; // Invalid log message signature
+        ReleaseLogs(cursor);
+    }
+
+    return skippedCount;
+}
+#endif // CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS
+
+size_t LogQueue::GetSize() const
+{
+    return mLogQueue.size;
+}
+
+size_t LogQueue::GetMaxMessageLength() const
+{
+    return mLogQueue.size - cLogHeaderMaxSize;
+}
+
+size_t LogQueue::GetUsedSize() const
+{
+    // The head is read first, so that the tail cannot be behind it
+    size_t head = mLogQueue.head.load(std::memory_order_relaxed);
+    size_t tail = mLogQueue.tail.load(std::memory_order_relaxed);
+
+    return std::min(tail - head, mLogQueue.size);
+}
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+void LogQueue::MoveHead(size_t index)
+{
+    size_t head = mLogQueue.head.load(std::memory_order_relaxed);
+
+    // Only move the head forward, the producer may have already dropped the peeked messages
+    while (((index - head) <= mLogQueue.size) && (index != head))
+    {
+#if CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+        // Clear the released space, so that no stale commit flag is seen once the producers reuse it
+        ClearQueue(head, index - head);
+#endif
+
+        if (mLogQueue.head.compare_exchange_weak(head, index, std::memory_order_release, std::memory_order_relaxed))
+        {
+            break;
+        }
+    }
+}
+
+#if CONFIG_COMMONS_LOGGING_OVERFLOW
+bool LogQueue::HoldLogs(LogCursor_t &readCursor)
+{
+    while (true)
+    {
+        readCursor.holdIndex.store(readCursor.readIndex, std::memory_order_relaxed);
+        readCursor.holding.store(true, std::memory_order_seq_cst);
+
+        // The head is only used if the producer did not drop log messages meanwhile, the next drop sees the cursor holding
+        uint32_t dropCount = mDropCount.load(std::memory_order_seq_cst);
+        size_t head = mLogQueue.head.load(std::memory_order_seq_cst);
+        size_t tail = mLogQueue.tail.load(std::memory_order_acquire);
+        if (((dropCount & 1) != 0) || (mDropCount.load(std::memory_order_seq_cst) != dropCount))
+        {
+            readCursor.holding.store(false, std::memory_order_relaxed);
+            return false;
+        }
+
+        if ((tail - readCursor.readIndex) <= (tail - head))
+        {
+            return true;
+        }
+
+        // The producer dropped the messages under the read index to make room
+        readCursor.holding.store(false, std::memory_order_relaxed);
+        readCursor.readIndex = head;
+    }
+}
+
+size_t LogQueue::GetNextLogIndex(size_t index, size_t tail, uint8_t &level)
+{
+    size_t availableData = tail - index;
+    uint8_t header[cLogHeaderMaxSize];
+    LogMetadata_t metadata;
+
+    CopyFromQueue(index, header, std::min(availableData, sizeof(header)));
+    size_t headerSize = DecodeHeader(header, std::min(availableData, sizeof(header)), metadata);
+
+    // The same checks as the consumer, so that both skip the same log messages
+    if ((headerSize == 0) ||
+        (metadata.length > (availableData - headerSize)) ||
+        ((metadata.level != LOG_PADDING_LEVEL) && (metadata.length > cLogMessageBufferSize)))
+    {
+        level = LOG_PADDING_LEVEL;
+        return tail;
     }
 
     level = metadata.level;
-    messageLength = std::min(metadata.length, cLogMessageBufferSize);
+    return index + headerSize + metadata.length;
+}
+#endif
+
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+uint64_t LogQueue::GetTimestampDelta(uint64_t timestamp) const
+{
+#if LOG_HEADER_TIMESTAMP_OFFSET
+    return timestamp - mTimestampEpoch;
+#else
+    return timestamp - mLastTimestamp;
+#endif
+}
+#endif
 
-    // Read the log message from the queue buffer
-    for (size_t i = 0; i < messageLength; ++i)
+bool LogQueue::HasSpace(size_t tail, size_t length)
+{
+    size_t head = mLogQueue.head.load(std::memory_order_acquire);
+
+#if CONFIG_COMMONS_LOGGING_OVERFLOW
+    if (length > mLogQueue.size)
     {
-        mMessageBuffer[i] = static_cast<uint8_t*>(pQueueBuffer)[head];
-        head = (head + 1) % queueSize;      // Wrap around if needed
+        // Dropping log messages cannot make room
+        return false;
     }
 
-    // Set the output pointer to the message buffer
-    pMessage = mMessageBuffer;
+    if (length <= (mLogQueue.size - (tail - head)))
+    {
+        return true;
+    }
 
-    return 0;
+    // The cursors do not start holding log messages while they are dropped, see HoldLogs()
+    mDropCount.fetch_add(1, std::memory_order_seq_cst);
+
+    // Not enough space, drop the oldest log messages one by one until the new one fits.
+    // The producer wrote them, so their headers can be read while the consumer moves the head.
+    uint8_t level;
+    size_t nextHead;
+    do
+    {
+        nextHead = head;
+        while (length > (mLogQueue.size - (tail - nextHead)))
+        {
+            nextHead = GetNextLogIndex(nextHead, tail, level);
+        }
+    } while (!mLogQueue.head.compare_exchange_weak(head, nextHead, std::memory_order_seq_cst, std::memory_order_acquire));
+
+    // A cursor may have started holding log messages before the head moved, they are given back.
+    // Nothing is written yet, so the cursor still reads them, and the new log message does not fit.
+    size_t keptHead = nextHead;
+    for (size_t i = 0; i < mCursorCount; ++i)
+    {
+        if (mCursors[i].holding.load(std::memory_order_seq_cst))
+        {
+            size_t holdIndex = mCursors[i].holdIndex.load(std::memory_order_relaxed);
+            if ((holdIndex - head) < (keptHead - head))
+            {
+                keptHead = holdIndex;
+            }
+        }
+    }
+
+    if (keptHead != nextHead)
+    {
+        // Fails only if the cursor released the held log messages meanwhile, and moved the head further
+        mLogQueue.head.compare_exchange_strong(nextHead, keptHead, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    // Count the dropped log messages, up to the first kept one
+    for (size_t index = head; (index - head) < (keptHead - head); )
+    {
+        index = GetNextLogIndex(index, tail, level);
+        if (level != LOG_PADDING_LEVEL)
+        {
+            CountDroppedLog(level);
+        }
+    }
+
+    mDropCount.fetch_add(1, std::memory_order_release);
+
+    if (length > (mLogQueue.size - (tail - mLogQueue.head.load(std::memory_order_acquire))))
+    {
+        return false;
+    }
+#else
+    if (length > (mLogQueue.size - (tail - head)))
+    {
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+void LogQueue::CopyToQueue(size_t index, const void* pData, size_t length)
+{
+    size_t offset = index & mLogQueue.mask;
+    size_t firstLength = std::min(length, mLogQueue.size - offset);
+
+    // At most two copies are needed, one up to the end of the buffer and one from its start
+    memcpy(&mLogQueue.pBuffer[offset], pData, firstLength);
+    memcpy(mLogQueue.pBuffer, static_cast<const uint8_t*>(pData) + firstLength, length - firstLength);
+}
+
+void LogQueue::CopyFromQueue(size_t index, void* pData, size_t length)
+{
+    size_t offset = index & mLogQueue.mask;
+    size_t firstLength = std::min(length, mLogQueue.size - offset);
+
+    // At most two copies are needed, one up to the end of the buffer and one from its start
+    memcpy(pData, &mLogQueue.pBuffer[offset], firstLength);
+    memcpy(static_cast<uint8_t*>(pData) + firstLength, mLogQueue.pBuffer, length - firstLength);
+}
+
+#if CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+size_t LogQueue::CopyHeaderFromQueue(size_t index, size_t length, uint8_t* pHeader)
+{
+    size_t maxLength = std::min(length, cLogHeaderMaxSize);
+    size_t headerLength = 0;
+
+    // The first byte and the varints are copied up to their last byte, the size of the header is known then.
+    // A varint takes at least one byte, so the smallest size of the varints is also their number.
+    size_t varintCount = cLogHeaderMinVarintsSize;
+    if (maxLength > 0)
+    {
+        CopyFromQueue(index, &pHeader[headerLength++], 1);
+    }
+    while ((varintCount > 0) && (headerLength < maxLength))
+    {
+        CopyFromQueue(index + headerLength, &pHeader[headerLength], 1);
+        if ((pHeader[headerLength++] & 0x80) == 0)
+        {
+            --varintCount;
+        }
+    }
+
+    size_t fieldsLength = std::min(cLogHeaderFieldsSize, maxLength - headerLength);
+    CopyFromQueue(index + headerLength, &pHeader[headerLength], fieldsLength);
+
+    return headerLength + fieldsLength;
+}
+
+void LogQueue::ClearQueue(size_t index, size_t length)
+{
+    size_t offset = index & mLogQueue.mask;
+    size_t firstLength = std::min(length, mLogQueue.size - offset);
+
+    memset(&mLogQueue.pBuffer[offset], 0, firstLength);
+    memset(mLogQueue.pBuffer, 0, length - firstLength);
 }
+#endif
@@ -10,6 +10,9 @@
 // Header includes
 // ----------------------------------------------------------------------------
 
+#include "LogToOutput.hpp"
+
+#include <atomic>
 #include <cstdint>
 #include <cstddef>
 
@@ -19,14 +22,46 @@
 // Datatype definitions
 // ----------------------------------------------------------------------------
 
+/*
+ * Single-consumer ring buffer.
+ *
+ * The head and tail are free-running indexes, they are converted into buffer offsets
+ * with the mask. So the used space is always (tail - head), even after the indexes wrap.
+ * The head is only written by the consumer. With a cursor per consumer, every consumer
+ * reads and releases at its own pace, and the head follows the slowest cursor.
+ *
+ * With a single producer, the tail is only written by the producer and publishes the log messages.
+ * With multiple producers, the tail is claimed atomically by the producers and every log message
+ * is published on its own by a commit flag, the consumer stops at the first uncommitted message.
+ */
 typedef struct
 {
-    void*   pBuffer;        // Pointer to the log buffer
-    size_t  size;           // Size of the log buffer
-    size_t  head;           // Head index for the log buffer
-    size_t  tail;           // Tail index for the log buffer
+    uint8_t*            pBuffer;    // Pointer to the log buffer
+    size_t              size;       // Size of the log buffer, always a power of two
+    size_t              mask;       // Mask to convert an index into a buffer offset
+    std::atomic<size_t> head;       // Read index, owned by the consumer
+    std::atomic<size_t> tail;       // Write index, owned by the producers
 } LogQueue_t;
 
+// Read position of a consumer in the log queue, only written by its consumer
+typedef struct
+{
+    size_t              readIndex;              // Index of the next log message to peek
+    size_t              lastPeekIndex;          // Index of the last peeked log message
+    std::atomic<size_t> releasedIndex;          // Index up to which the log messages are released
+#if CONFIG_COMMONS_LOGGING_OVERFLOW
+    std::atomic<bool>   holding;                // The producer keeps the log messages from holdIndex on
+    std::atomic<size_t> holdIndex;              // Index of the oldest peeked log message which is not released
+#endif
+#if !(CONFIG_COMMONS_LOGGING_QUEUE_PER_CPU || CONFIG_COMMONS_LOGGING_QUEUE_PER_THREAD || CONFIG_COMMONS_LOGGING_PRIORITY_LANE)
+    uint32_t            readSequenceNumber;     // Sequence number of the next log message to peek
+#endif
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP && !CONFIG_COMMONS_LOGGING_QUEUE_MPSC && !CONFIG_COMMONS_LOGGING_OVERFLOW
+    uint64_t            readTimestamp;          // Time of the last peeked log message
+    uint64_t            lastPeekTimestamp;      // Time of the log message before the last peeked one
+#endif
+} LogCursor_t;
+
 // ----------------------------------------------------------------------------
 // Class definition
 // ----------------------------------------------------------------------------
@@ -34,46 +69,300 @@ typedef struct
 class LogQueue
 {
 public:
+    // Number of levels a queued log message can have
+    static constexpr size_t cLevelCount = 16;
+
+    // Maximum number of read cursors
+    static constexpr size_t cCursorCount = LOG_CURSOR_COUNT;
+
     /**
      * @brief Initialize the log queue with a buffer.
      *
      * This method initializes the log queue with a buffer that will be used to store log messages.
+     * Only the largest power of two that fits in the buffer is used.
      *
      * @param[in] pBuffer A pointer to the log buffer.
      * @param[in] size The size of the log buffer.
+     * @param[in] cursorCount Number of read cursors, every cursor must release a log message before its space is reused.
      */
-    static void Initialize(void* pBuffer, size_t size);
+    void Initialize(void* pBuffer, size_t size, size_t cursorCount = 1);
 
     /**
      * @brief Push a log message to the log queue.
      *
      * This method is used to send a log message to the log queue.
+     * It must only be called from the producer context, unless CONFIG_COMMONS_LOGGING_QUEUE_MPSC is enabled.
      *
      * @param[in] pMessage A pointer to the log message.
      * @param[in] messageLength The length of the log message.
      * @param[in] level The log level of the message.
+     * @param[in] pSource The origin of the message, or nullptr if unknown.
      *
      * @return int Returns 0 on success, otherwise returns an error code.
      */
-    static int PushLog(const uint8_t* pMessage, size_t messageLength, int level);
+    int PushLog(const uint8_t* pMessage, size_t messageLength, int level, const LogSource_t* pSource = nullptr);
+
+#if !CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+    /**
+     * @brief Reserve a contiguous slot in the log queue for the next log message.
+     *
+     * The producer writes the message directly into the returned slot and publishes it
+     * with Commit(). If the slot does not fit before the end of the buffer, the remaining
+     * bytes are skipped with a padding record and the slot starts at the beginning of the buffer.
+     * It must only be called from the producer context.
+     *
+     * @param[in] maxLength The maximum length of the log message that will be written into the slot.
+     *
+     * @return uint8_t* Pointer to the reserved slot, or nullptr if there is not enough space
+     *                  or if the slot is larger than the log queue.
+     */
+    uint8_t* Reserve(size_t maxLength);
+
+    /**
+     * @brief Commit the log message written into the slot returned by Reserve().
+     *
+     * A length of zero abandons the reservation without publishing a log message.
+     *
+     * @param[in] messageLength The actual length of the log message, must not exceed the reserved length.
+     * @param[in] level The log level of the message.
+     * @param[in] pSource The origin of the message, or nullptr if unknown.
+     */
+    void Commit(size_t messageLength, int level, const LogSource_t* pSource = nullptr);
+#endif // !CONFIG_COMMONS_LOGGING_QUEUE_MPSC
 
     /**
-     * @brief Pull a log message from the log queue.
+     * @brief Peek the next log message in the log queue.
      *
-     * This method retrieves a log message from the log queue.
+     * The log message is returned as views into the queue buffer, so it is not copied.
+     * The views stay valid until ReleaseLogs() is called. Consecutive calls return
+     * the subsequent log messages. It must only be called from the consumer context of the cursor.
      *
-     * @param[out] pMessage A pointer to the retrieved log message.
-     * @param[out] messageLength The length of the retrieved log message.
-     * @param[out] level The log level of the retrieved message.
+     * @param[out] record The peeked log message.
+     * @param[in] cursor The read cursor.
      *
      * @return int Returns 0 on success, otherwise returns an error code.
      */
-    static int PullLog(uint8_t* &pMessage, size_t &messageLength, int &level);
+    int PeekLog(LogRecord_t &record, size_t cursor = 0);
+
+    /**
+     * @brief Return the last peeked log message to the log queue, so that the next call to PeekLog() returns it again.
+     *
+     * It must only be called from the consumer context of the cursor.
+     *
+     * @param[in] cursor The read cursor.
+     */
+    void UnpeekLog(size_t cursor = 0);
+
+    /**
+     * @brief Release all the peeked log messages of a cursor.
+     *
+     * Their space can be reused by the producer once all the cursors released them.
+     * It must only be called from the consumer context of the cursor.
+     *
+     * @param[in] cursor The read cursor.
+     */
+    void ReleaseLogs(size_t cursor = 0);
+
+#if CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS
+    /**
+     * @brief Skip and release the oldest log messages of a cursor which lags too far behind the producers.
+     *
+     * The skipped log messages are counted as dropped for this cursor only.
+     * It must only be called from the consumer context of the cursor, without peeked log messages.
+     *
+     * @param[in] cursor The read cursor.
+     * @param[in] maxLagSize Number of bytes the cursor may leave unread.
+     *
+     * @return size_t Number of skipped log messages.
+     */
+    size_t SkipLogs(size_t cursor, size_t maxLagSize);
+#endif
+
+    /**
+     * @brief Get the size of the log queue.
+     *
+     * @return size_t Size of the log queue in bytes.
+     */
+    size_t GetSize() const;
+
+    /**
+     * @brief Get the length of the largest log message which always fits in the log queue, whatever its header.
+     *
+     * @return size_t Length in bytes.
+     */
+    size_t GetMaxMessageLength() const;
+
+    /**
+     * @brief Get the number of bytes used in the log queue, including the headers.
+     *
+     * It can be called from any context, the result may already be stale.
+     *
+     * @return size_t Number of used bytes.
+     */
+    size_t GetUsedSize() const;
+
+    /**
+     * @brief Count a dropped log message, for all the cursors.
+     *
+     * The counters are shared by all the log queues. It can be called from any context.
+     *
+     * @param[in] level The log level of the message, as it would have been queued.
+     */
+    static void CountDroppedLog(int level);
+
+    /**
+     * @brief Take the counts of the log messages dropped since the previous call, and reset them.
+     *
+     * @param[out] counts Number of dropped log messages, for every queued level.
+     * @param[in] cursor The read cursor, every cursor has its own counts.
+     *
+     * @return uint32_t Total number of dropped log messages.
+     */
+    static uint32_t TakeDroppedLogs(uint32_t (&counts)[cLevelCount], size_t cursor = 0);
+
+#if CONFIG_COMMONS_LOGGING_STATS
+    /**
+     * @brief Get the counts of the log messages dropped since the start, which TakeDroppedLogs() does not reset.
+     *
+     * @param[out] counts Number of dropped log messages, for every queued level.
+     */
+    static void GetTotalDroppedLogs(uint32_t (&counts)[cLevelCount]);
+#endif
 
 private:
 
-    static LogQueue_t          mLogQueue;                                                   // Queue to store log messages
-    inline static const size_t cLogMessageBufferSize = CONFIG_COMMONS_LOGGING_BUFFER_SIZE;  // Size of the log message buffer
-    static uint8_t             mMessageBuffer[cLogMessageBufferSize + 1];                   // Buffer to hold the log message
-    static uint32_t            mSequenceNumber;                                             // Sequence number for log messages
+    /**
+     * @brief Check if the given number of bytes can be written at the tail.
+     *
+     * When overflow is enabled, the oldest messages are dropped one by one to make room,
+     * and counted as dropped. The messages peeked by a cursor and not released yet are kept,
+     * the dropping stops at the oldest of them and the bytes do not fit then.
+     *
+     * @param[in] tail Current tail index.
+     * @param[in] length Number of bytes to be written.
+     *
+     * @return bool Returns true if the bytes can be written, otherwise false.
+     */
+    bool HasSpace(size_t tail, size_t length);
+
+#if CONFIG_COMMONS_LOGGING_OVERFLOW
+    /**
+     * @brief Make the producer keep the log messages from the read index of a cursor on, until they are released.
+     *
+     * The read index moves to the head first, if the producer dropped the log messages under it.
+     *
+     * @param[in] readCursor The read cursor.
+     *
+     * @return bool Returns true if the log messages are kept, or false if the producer is dropping log messages.
+     */
+    bool HoldLogs(LogCursor_t &readCursor);
+
+    /**
+     * @brief Get the index of the log message which follows a queued one, from its header.
+     *
+     * @param[in] index Index of the queued log message.
+     * @param[in] tail Current tail index.
+     * @param[out] level Level of the queued log message, LOG_PADDING_LEVEL for padding or invalid data.
+     *
+     * @return size_t Index of the next log message, or the tail if the queued data is invalid.
+     */
+    size_t GetNextLogIndex(size_t index, size_t tail, uint8_t &level);
+#endif
+
+    /**
+     * @brief Move the head forward, to the given index.
+     *
+     * @param[in] index Index up to which all the cursors released the log messages.
+     */
+    void MoveHead(size_t index);
+
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    /**
+     * @brief Get the time to store in the header of a log message.
+     *
+     * With a single producer, it is the time since the previous log message of the queue.
+     * Otherwise it is the time since the queue initialization.
+     *
+     * @param[in] timestamp Time of the log message.
+     *
+     * @return uint64_t The time to store in the header.
+     */
+    uint64_t GetTimestampDelta(uint64_t timestamp) const;
+#endif
+
+    /**
+     * @brief Copy data into the queue buffer, splitting the copy at the end of the buffer.
+     *
+     * @param[in] index Free-running index of the first byte to write.
+     * @param[in] pData Pointer to the data to copy.
+     * @param[in] length Number of bytes to copy.
+     */
+    void CopyToQueue(size_t index, const void* pData, size_t length);
+
+    /**
+     * @brief Copy data out of the queue buffer, splitting the copy at the end of the buffer.
+     *
+     * @param[in] index Free-running index of the first byte to read.
+     * @param[out] pData Pointer to the destination buffer.
+     * @param[in] length Number of bytes to copy.
+     */
+    void CopyFromQueue(size_t index, void* pData, size_t length);
+
+#if CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+    /**
+     * @brief Copy the header of a committed log message out of the queue buffer, without the bytes following it.
+     *
+     * The bytes after a short log message may be claimed and written by another producer, so they are not read.
+     *
+     * @param[in] index Free-running index of the header.
+     * @param[in] length Number of queued bytes from the index.
+     * @param[out] pHeader Pointer to the buffer receiving the header, at least cLogHeaderMaxSize bytes.
+     *
+     * @return size_t Number of bytes copied, the size of the header unless it is invalid.
+     */
+    size_t CopyHeaderFromQueue(size_t index, size_t length, uint8_t* pHeader);
+
+    /**
+     * @brief Clear the queue buffer, splitting at the end of the buffer.
+     *
+     * @param[in] index Free-running index of the first byte to clear.
+     * @param[in] length Number of bytes to clear.
+     */
+    void ClearQueue(size_t index, size_t length);
+#endif
+
+    LogQueue_t                   mLogQueue;                                                   // Queue to store log messages
+    inline static const size_t   cLogMessageBufferSize = CONFIG_COMMONS_LOGGING_BUFFER_SIZE;  // Size of the log message buffer
+    inline static std::atomic<uint32_t> mDroppedCounts[cCursorCount][cLevelCount] = {};      // Number of dropped log messages per cursor and level
+#if CONFIG_COMMONS_LOGGING_STATS
+    inline static std::atomic<uint32_t> mTotalDroppedCounts[cLevelCount] = {};               // Number of dropped log messages per level since the start
+#endif
+#if CONFIG_COMMONS_LOGGING_QUEUE_PER_CPU || CONFIG_COMMONS_LOGGING_QUEUE_PER_THREAD || CONFIG_COMMONS_LOGGING_PRIORITY_LANE
+    inline static std::atomic<uint32_t> mSequenceNumber = 0;                                  // Sequence number shared by all the log queues
+#endif
+#if CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+    std::atomic<uint32_t>        mWriterCount = 0;                                            // Number of producers which claimed space, but did not commit it yet
+#endif
+#if CONFIG_COMMONS_LOGGING_OVERFLOW
+    std::atomic<uint32_t>        mDropCount = 0;                                              // Incremented when the producer starts and stops dropping, odd in between
+#endif
+#if !CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+    size_t                       mReservedIndex = 0;                                          // Index of the reserved record
+    size_t                       mReservedLength = 0;                                         // Length of the reserved slot, 0 if none
+#endif
+    LogCursor_t                  mCursors[cCursorCount] = {};                                 // Read cursors of the consumers
+    size_t                       mCursorCount = 1;                                            // Number of read cursors in use
+#if CONFIG_COMMONS_LOGGING_CONSUMER_CURSORS
+    std::atomic<bool>            mHeadUpdateRequested = false;                                // A cursor released log messages since the head was moved
+    std::atomic<bool>            mHeadUpdateInProgress = false;                               // A cursor is moving the head
+#endif
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    uint64_t                     mTimestampEpoch = 0;                                         // Time of the queue initialization
+#if !CONFIG_COMMONS_LOGGING_QUEUE_MPSC
+    uint64_t                     mReservedTimestamp = 0;                                      // Time of the reserved record
+#endif
+#if !CONFIG_COMMONS_LOGGING_QUEUE_MPSC && !CONFIG_COMMONS_LOGGING_OVERFLOW
+    uint64_t                     mLastTimestamp = 0;                                          // Time of the last queued log message, owned by the producer
+#endif
+#endif
 };
@@ -0,0 +1,59 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogTokenDatabase.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ----------------------------------------------------------------------------
+// Class definition
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Turns the tokenized log messages back into text.
+ *
+ * A tokenized log message is the 32 bit token of its format string, little endian, followed by the arguments
+ * as encoded by pw_tokenizer: the integers as zigzag varints, the floating point numbers as 32 bit floats,
+ * and the strings as a length byte, whose top bit tells if the string is truncated, followed by the characters.
+ */
+class LogDetokenizer
+{
+public:
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] database The token database, which must outlive the detokenizer.
+     */
+    explicit LogDetokenizer(const LogTokenDatabase &database) :
+        mDatabase(database)
+    {
+    }
+
+    /**
+     * @brief Detokenizes a log message.
+     *
+     * @param[in] pMessage Pointer to the tokenized log message.
+     * @param[in] length Length of the tokenized log message.
+     * @param[out] output The string the text is appended to, without the trailing newline of the format string.
+     *
+     * @return int Returns 0 on success, -EMSGSIZE if the message is shorter than a token, -ENOENT if the
+     *             token is unknown, or -EINVAL if the arguments do not match the format string. Nothing is
+     *             appended on -EMSGSIZE and -ENOENT. On -EINVAL, the conversions which could not be decoded
+     *             are appended as they are in the format string.
+     */
+    int Detokenize(const uint8_t* pMessage, size_t length, std::string &output) const;
+
+private:
+    const LogTokenDatabase &mDatabase;  // Token database
+};
@@ -0,0 +1,134 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogFrameFormat.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+// Datatype definitions
+// ----------------------------------------------------------------------------
+
+// Log message decoded from a frame
+typedef struct
+{
+    int             level;              // Log level
+    uint32_t        sequenceNumber;     // Sequence number for the log message
+    bool            hasTimestamp;       // The frame carries the timestamp
+    uint64_t        timestamp;          // Time of the log message, in ticks of the log clock of the target
+    const uint8_t*  pMessage;           // Tokenized log message, valid until the callback returns
+    size_t          length;             // Length of the tokenized log message
+} LogFrameRecord_t;
+
+// Statistics of a decoded stream since the start, or the last reset
+typedef struct
+{
+    uint64_t    frameCount;             // Frames decoded and handed over to the callback
+    uint64_t    crcErrorCount;          // Frames dropped for a wrong CRC
+    uint64_t    formatErrorCount;       // Frames dropped for a malformed COBS encoding or payload
+    uint64_t    overflowCount;          // Frames dropped for a payload larger than cMaxPayloadSize
+    uint64_t    sequenceGapCount;       // Decoded frames which do not follow the previous one
+    uint64_t    discardedByteCount;     // Bytes of the dropped frames
+} LogFrameDecoderStats_t;
+
+// ----------------------------------------------------------------------------
+// Class definition
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Decodes a stream of log frames, as written by the consumers using LOG_OUTPUT_FORMAT_FRAMED.
+ *
+ * The stream is decoded incrementally, in chunks of any size, so a frame may be split across several
+ * calls to Decode(). A corrupted frame is dropped up to the next delimiter, where the decoding resumes.
+ * Consecutive delimiters are ignored, so a sender may send one to end a partial frame, eg: after a reset.
+ */
+class LogFrameDecoder
+{
+public:
+    /**
+     * @brief Callback receiving every decoded log message, in the order of the stream.
+     *
+     * @param[in] record The log message and its metadata.
+     * @param[in] pContext Context given to the constructor.
+     */
+    typedef void (*Callback_t)(const LogFrameRecord_t& record, void* pContext);
+
+    // Largest payload of a frame, longer frames are dropped
+    static constexpr size_t cMaxPayloadSize = LOG_FRAME_MAX_PAYLOAD_SIZE(4096);
+
+    /**
+     * @brief Constructor.
+     *
+     * The CRC flag is part of the payload it protects, so a corruption which clears it would go unnoticed.
+     * When the target sends a CRC in every frame, the frames without it are dropped as malformed.
+     *
+     * @param[in] callback Function receiving the decoded log messages.
+     * @param[in] pContext Context passed to the callback.
+     * @param[in] crcRequired True if the target is built with CONFIG_COMMONS_LOGGING_FRAMING_CRC.
+     */
+    LogFrameDecoder(Callback_t callback, void* pContext, bool crcRequired = true);
+
+    /**
+     * @brief Decodes the next bytes of the stream.
+     *
+     * The callback is called for every frame completed by these bytes.
+     *
+     * @param[in] pData Pointer to the bytes.
+     * @param[in] length Number of bytes.
+     */
+    void Decode(const uint8_t* pData, size_t length);
+
+    /**
+     * @brief Ends the stream, the partial frame is dropped and its bytes are counted as discarded.
+     */
+    void Finish();
+
+    /**
+     * @brief Drops the partial frame and clears the statistics, eg: before decoding another stream.
+     */
+    void Reset();
+
+    /**
+     * @brief Gets the statistics of the stream.
+     *
+     * @return const LogFrameDecoderStats_t& The statistics since the start, or the last reset.
+     */
+    const LogFrameDecoderStats_t& GetStats() const
+    {
+        return mStats;
+    }
+
+private:
+    /**
+     * @brief Decodes the payload of a complete frame, and hands the log message over to the callback.
+     */
+    void DecodePayload();
+
+    /**
+     * @brief Drops the rest of the current frame, up to the next delimiter.
+     */
+    void DropFrame();
+
+    Callback_t              mCallback;                  // Function receiving the decoded log messages
+    void*                   mpContext;                  // Context passed to the callback
+    bool                    mCrcRequired;               // The frames without a CRC are dropped
+    uint8_t                 mPayload[cMaxPayloadSize];  // Payload of the current frame, decoded so far
+    size_t                  mLength;                    // Number of bytes of the payload decoded so far
+    size_t                  mFrameByteCount;            // Number of bytes of the current frame received so far
+    uint8_t                 mCode;                      // Code byte of the current COBS block, 0 before the first block
+    uint8_t                 mRemaining;                 // Number of bytes of the current COBS block still to receive
+    bool                    mDropping;                  // The current frame is dropped up to the next delimiter
+    bool                    mSequenceNumberValid;       // A frame was decoded, so its sequence number is valid
+    uint32_t                mLastSequenceNumber;        // Sequence number of the last decoded frame
+    LogFrameDecoderStats_t  mStats;                     // Statistics of the stream
+};
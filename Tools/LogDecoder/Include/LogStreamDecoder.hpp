@@ -0,0 +1,132 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogDetokenizer.hpp"
+#include "LogFrameDecoder.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Datatype definitions
+// ----------------------------------------------------------------------------
+
+// Format of a captured log stream
+typedef enum
+{
+    LOG_STREAM_FORMAT_BASE64,   // Text lines, with the tokenized log messages Base64 encoded after a '$'
+    LOG_STREAM_FORMAT_FRAMED,   // Binary frames, see LogFrameFormat.h
+} LogStreamFormat_t;
+
+// Statistics of a decoded stream
+typedef struct
+{
+    uint64_t                messageCount;           // Log messages detokenized
+    uint64_t                unknownTokenCount;      // Log messages whose token is not in the database
+    uint64_t                argumentErrorCount;     // Log messages whose arguments do not match the format string
+    LogFrameDecoderStats_t  frames;                 // Statistics of the frames, only for a framed stream
+} LogStreamStats_t;
+
+// ----------------------------------------------------------------------------
+// Class definition
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Decodes and detokenizes a captured log stream incrementally.
+ *
+ * In a Base64 stream, every "$..." is replaced by its text, and the rest of the lines is kept, so the log
+ * messages may be mixed with other output. A "$..." which cannot be detokenized is kept as is. In a framed
+ * stream, every frame becomes one line, starting with the timestamp when the frame carries it.
+ *
+ * A decoder holds the state of one stream. A large capture may be split at line ends, or frame delimiters,
+ * and the parts decoded by separate decoders in parallel.
+ */
+class LogStreamDecoder
+{
+public:
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] database The token database, which must outlive the decoder.
+     * @param[in] format The format of the stream.
+     * @param[in] crcRequired True if every frame must carry a CRC, see LogFrameDecoder.
+     * @param[in] timestampFrequency Frequency of the log clock of the target in Hz, to print the timestamps
+     *                               in seconds, or 0 to print them in ticks.
+     */
+    LogStreamDecoder(const LogTokenDatabase &database, LogStreamFormat_t format, bool crcRequired = true,
+                     uint64_t timestampFrequency = 0);
+
+    /**
+     * @brief Decodes the next bytes of the stream.
+     *
+     * The text of every line or frame completed by these bytes is appended to the output.
+     *
+     * @param[in] pData Pointer to the bytes.
+     * @param[in] length Number of bytes.
+     * @param[out] output The string the text is appended to.
+     */
+    void Decode(const uint8_t* pData, size_t length, std::string &output);
+
+    /**
+     * @brief Ends the stream, the last line is decoded even without its line end, and a partial frame is dropped.
+     *
+     * @param[out] output The string the text is appended to.
+     */
+    void Finish(std::string &output);
+
+    /**
+     * @brief Gets the statistics of the stream.
+     *
+     * @return LogStreamStats_t The statistics since the start.
+     */
+    LogStreamStats_t GetStats() const;
+
+private:
+    /**
+     * @brief Appends the text of a frame to the output, called by the frame decoder.
+     *
+     * @param[in] record The decoded frame.
+     * @param[in] pContext The stream decoder.
+     */
+    static void HandleFrame(const LogFrameRecord_t &record, void* pContext);
+
+    /**
+     * @brief Detokenizes the "$..." of a line of a Base64 stream.
+     *
+     * @param[in] pLine Pointer to the line, its line end included if any.
+     * @param[in] length Length of the line.
+     * @param[out] output The string the text is appended to.
+     */
+    void DecodeLine(const char* pLine, size_t length, std::string &output);
+
+    /**
+     * @brief Detokenizes a log message, and counts the errors.
+     *
+     * @param[in] pMessage Pointer to the tokenized log message.
+     * @param[in] length Length of the tokenized log message.
+     * @param[out] output The string the text is appended to.
+     *
+     * @return int Returns the result of LogDetokenizer::Detokenize().
+     */
+    int DetokenizeMessage(const uint8_t* pMessage, size_t length, std::string &output);
+
+    LogDetokenizer          mDetokenizer;           // Detokenizer of the log messages
+    LogStreamFormat_t       mFormat;                // Format of the stream
+    uint64_t                mTimestampFrequency;    // Frequency of the log clock of the target, 0 if unknown
+    LogFrameDecoder         mFrameDecoder;          // Decoder of the frames of a framed stream
+    std::string*            mpOutput;               // Output of the frames decoded by the current Decode() call
+    std::string             mLine;                  // Start of the line split across Decode() calls
+    std::vector<uint8_t>    mMessage;               // Log message decoded from Base64
+    LogStreamStats_t        mStats;                 // Statistics of the log messages
+};
@@ -0,0 +1,162 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Datatype definitions
+// ----------------------------------------------------------------------------
+
+// Slot of the hash table of the tokens
+typedef struct
+{
+    uint32_t    token;          // Token of the string
+    uint32_t    stringOffset;   // Position of the string in the string pool, UINT32_MAX for an empty slot
+} LogTokenEntry_t;
+
+// String read from the database, before it is added to the hash table
+typedef struct
+{
+    uint32_t    token;          // Token of the string
+    uint32_t    stringOffset;   // Position of the string in the string pool
+    bool        removed;        // The string has a removal date, it is only used if no other string has the token
+} LogTokenString_t;
+
+// ----------------------------------------------------------------------------
+// Class definition
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Token database of pw_tokenizer, as created by database.py in the CSV format.
+ *
+ * The strings are stored one after another in a single pool, and the tokens in an open addressing hash
+ * table of 8 byte slots, which is at most half full. A lookup hashes the token once and usually reads a
+ * single cache line of the table. Several databases may be loaded, eg: one per firmware image.
+ */
+class LogTokenDatabase
+{
+public:
+    /**
+     * @brief Loads a database file.
+     *
+     * @param[in] pPath Path of the CSV file.
+     *
+     * @return int Returns 0 on success, -errno if the file cannot be read, or -EINVAL if it is malformed.
+     */
+    int Load(const char* pPath);
+
+    /**
+     * @brief Loads a database from memory.
+     *
+     * Every line holds the token in hexadecimal, the removal date, optionally the domain, and the string,
+     * eg: 141c35d5,          ,"","The answer: ""%s""". A string may span several lines within its quotes.
+     *
+     * @param[in] pText Pointer to the content of the CSV file.
+     * @param[in] length Length of the content in bytes.
+     *
+     * @return int Returns 0 on success, or -EINVAL if a line is malformed. The lines before it are kept.
+     */
+    int Parse(const char* pText, size_t length);
+
+    /**
+     * @brief Finds the string of a token.
+     *
+     * When several strings have the same token, the first one without a removal date is returned.
+     *
+     * @param[in] token The token.
+     *
+     * @return const char* The null terminated string, or nullptr if the token is unknown.
+     */
+    const char* Find(uint32_t token) const
+    {
+        if (mEntries.empty())
+        {
+            return nullptr;
+        }
+
+        size_t mask = mEntries.size() - 1;
+        for (size_t i = Hash(token); ; i = (i + 1) & mask)
+        {
+            const LogTokenEntry_t &entry = mEntries[i];
+            if (entry.stringOffset == UINT32_MAX)
+            {
+                return nullptr;
+            }
+
+            if (entry.token == token)
+            {
+                return &mStrings[entry.stringOffset];
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the number of distinct tokens.
+     *
+     * @return size_t Number of tokens in the hash table.
+     */
+    size_t GetCount() const
+    {
+        return mCount;
+    }
+
+    /**
+     * @brief Gets the number of strings hidden by another string with the same token.
+     *
+     * @return size_t Number of token collisions, the same string loaded twice is not one.
+     */
+    size_t GetCollisionCount() const
+    {
+        return mCollisionCount;
+    }
+
+private:
+    /**
+     * @brief Gets the first slot of a token in the hash table.
+     *
+     * The token is mixed with a Fibonacci hash, whose high bits select the slot, so that
+     * the tokens which only differ in their high bits do not probe the same slots.
+     *
+     * @param[in] token The token.
+     *
+     * @return size_t The first slot to probe.
+     */
+    size_t Hash(uint32_t token) const
+    {
+        return static_cast<size_t>((token * UINT32_C(0x9E3779B1)) >> (32 - mShift));
+    }
+
+    /**
+     * @brief Adds a line of the database.
+     *
+     * @param[in] fields The fields of the line, unquoted.
+     * @param[in] fieldCount Number of fields of the line.
+     *
+     * @return int Returns 0 on success, or -EINVAL if the line is malformed.
+     */
+    int AddLine(const std::vector<std::string> &fields, size_t fieldCount);
+
+    /**
+     * @brief Builds the hash table from all the strings read so far.
+     */
+    void Build();
+
+    std::vector<LogTokenEntry_t>    mEntries;           // Hash table of the tokens, its size is a power of two
+    std::vector<char>               mStrings;           // Pool of the null terminated strings
+    std::vector<LogTokenString_t>   mTokenStrings;      // All the strings read, in the order of the databases
+    size_t                          mCount = 0;         // Number of tokens in the hash table
+    size_t                          mCollisionCount = 0; // Number of strings hidden by another one
+    unsigned int                    mShift = 0;         // Number of bits of the slot positions
+};
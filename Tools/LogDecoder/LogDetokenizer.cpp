@@ -0,0 +1,367 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogDetokenizer.hpp"
+
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+// Size of the token at the start of a tokenized log message
+#define LOG_TOKEN_SIZE              4
+
+// A 64 bit varint takes at most 10 bytes
+#define LOG_ARG_MAX_VARINT_SIZE     10
+
+// The top bit of the length byte of a string tells if it is truncated
+#define LOG_ARG_STRING_TRUNCATED    0x80
+#define LOG_ARG_STRING_LENGTH_MASK  0x7F
+
+// Largest width or precision read from the arguments for a '*', a larger one is a corrupted argument
+#define LOG_ARG_MAX_WIDTH           1024
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Decodes an integer argument, a zigzag varint.
+ *
+ * @param[in] pArgs Pointer to the arguments.
+ * @param[in] length Length of the arguments in bytes.
+ * @param[in,out] offset Position of the argument, moved after it.
+ * @param[out] value The decoded value.
+ *
+ * @return bool Returns true on success, false if the varint is truncated or too long.
+ */
+static bool ReadInteger(const uint8_t* pArgs, size_t length, size_t &offset, int64_t &value)
+{
+    uint64_t encodedValue = 0;
+
+    for (size_t i = 0; (i < LOG_ARG_MAX_VARINT_SIZE) && (offset < length); ++i)
+    {
+        uint8_t byte = pArgs[offset++];
+        encodedValue |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0)
+        {
+            value = static_cast<int64_t>((encodedValue >> 1) ^ (~(encodedValue & 1) + 1));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Decodes a floating point argument, a little endian 32 bit float.
+ *
+ * @param[in] pArgs Pointer to the arguments.
+ * @param[in] length Length of the arguments in bytes.
+ * @param[in,out] offset Position of the argument, moved after it.
+ * @param[out] value The decoded value.
+ *
+ * @return bool Returns true on success, false if the argument is truncated.
+ */
+static bool ReadFloat(const uint8_t* pArgs, size_t length, size_t &offset, float &value)
+{
+    if ((length - offset) < sizeof(float))
+    {
+        return false;
+    }
+
+    uint32_t bits = static_cast<uint32_t>(pArgs[offset]) | (static_cast<uint32_t>(pArgs[offset + 1]) << 8) |
+                    (static_cast<uint32_t>(pArgs[offset + 2]) << 16) | (static_cast<uint32_t>(pArgs[offset + 3]) << 24);
+    memcpy(&value, &bits, sizeof(value));
+    offset += sizeof(float);
+
+    return true;
+}
+
+/**
+ * @brief Decodes a string argument, a length byte followed by the characters.
+ *
+ * @param[in] pArgs Pointer to the arguments.
+ * @param[in] length Length of the arguments in bytes.
+ * @param[in,out] offset Position of the argument, moved after it.
+ * @param[out] value The decoded string.
+ * @param[out] truncated True if the string was truncated by the target.
+ *
+ * @return bool Returns true on success, false if the argument is truncated.
+ */
+static bool ReadString(const uint8_t* pArgs, size_t length, size_t &offset, std::string &value, bool &truncated)
+{
+    if (offset >= length)
+    {
+        return false;
+    }
+
+    size_t stringLength = pArgs[offset] & LOG_ARG_STRING_LENGTH_MASK;
+    truncated = ((pArgs[offset] & LOG_ARG_STRING_TRUNCATED) != 0);
+    if ((length - offset - 1) < stringLength)
+    {
+        return false;
+    }
+
+    value.assign(reinterpret_cast<const char*>(&pArgs[offset + 1]), stringLength);
+    offset += 1 + stringLength;
+
+    return true;
+}
+
+/**
+ * @brief Appends a formatted value to a string.
+ *
+ * @param[out] output The string the formatted value is appended to.
+ * @param[in] pFormat The conversion of the value.
+ */
+static void AppendFormatted(std::string &output, const char* pFormat, ...)
+{
+    char buffer[256];
+    va_list args;
+
+    va_start(args, pFormat);
+    int length = vsnprintf(buffer, sizeof(buffer), pFormat, args);
+    va_end(args);
+
+    if (length < 0)
+    {
+        return;
+    }
+
+    if (static_cast<size_t>(length) < sizeof(buffer))
+    {
+        output.append(buffer, static_cast<size_t>(length));
+        return;
+    }
+
+    // A large width, formatted again straight into the output
+    size_t start = output.size();
+    output.resize(start + static_cast<size_t>(length) + 1);
+
+    va_start(args, pFormat);
+    vsnprintf(&output[start], static_cast<size_t>(length) + 1, pFormat, args);
+    va_end(args);
+
+    output.resize(start + static_cast<size_t>(length));
+}
+
+/**
+ * @brief Converts an integer argument to unsigned.
+ *
+ * The target encodes the arguments up to 32 bits as 32 bit signed integers, so a negative value in
+ * that range is a 32 bit unsigned value, unless the conversion is explicitly 64 bit.
+ *
+ * @param[in] value The decoded argument.
+ * @param[in] longLong True if the conversion is 64 bit.
+ *
+ * @return unsigned long long The unsigned value.
+ */
+static unsigned long long ToUnsigned(int64_t value, bool longLong)
+{
+    if (!longLong && (value < 0) && (value >= INT32_MIN))
+    {
+        return static_cast<uint32_t>(value);
+    }
+
+    return static_cast<unsigned long long>(value);
+}
+
+// ----------------------------------------------------------------------------
+// Public functions
+// ----------------------------------------------------------------------------
+
+int LogDetokenizer::Detokenize(const uint8_t* pMessage, size_t length, std::string &output) const
+{
+    if (length < LOG_TOKEN_SIZE)
+    {
+        return -EMSGSIZE;
+    }
+
+    uint32_t token = static_cast<uint32_t>(pMessage[0]) | (static_cast<uint32_t>(pMessage[1]) << 8) |
+                     (static_cast<uint32_t>(pMessage[2]) << 16) | (static_cast<uint32_t>(pMessage[3]) << 24);
+    const char* pFormat = mDatabase.Find(token);
+    if (pFormat == nullptr)
+    {
+        return -ENOENT;
+    }
+
+    size_t start = output.size();
+    size_t offset = LOG_TOKEN_SIZE;
+    int result = 0;
+    std::string conversion;
+    std::string string;
+
+    while (*pFormat != '\0')
+    {
+        const char* pPercent = strchr(pFormat, '%');
+        if (pPercent == nullptr)
+        {
+            output.append(pFormat);
+            break;
+        }
+
+        output.append(pFormat, static_cast<size_t>(pPercent - pFormat));
+        pFormat = pPercent + 1;
+
+        if (*pFormat == '%')
+        {
+            output.push_back('%');
+            ++pFormat;
+            continue;
+        }
+
+        // The flags, width and precision are kept in the conversion given to snprintf,
+        // a width or a precision passed as argument is replaced by its value
+        bool valid = true;
+        conversion.assign(1, '%');
+        while ((*pFormat != '\0') && (strchr("-+ #0", *pFormat) != nullptr))
+        {
+            conversion.push_back(*pFormat++);
+        }
+
+        for (int part = 0; part < 2; ++part)
+        {
+            if (part == 1)
+            {
+                if (*pFormat != '.')
+                {
+                    break;
+                }
+                conversion.push_back(*pFormat++);
+            }
+
+            if (*pFormat == '*')
+            {
+                int64_t value = 0;
+                valid = valid && ReadInteger(pMessage, length, offset, value) &&
+                        (value >= -LOG_ARG_MAX_WIDTH) && (value <= LOG_ARG_MAX_WIDTH);
+                conversion += std::to_string(value);
+                ++pFormat;
+            }
+
+            while ((*pFormat >= '0') && (*pFormat <= '9'))
+            {
+                conversion.push_back(*pFormat++);
+            }
+        }
+
+        // The length modifiers only matter for the 64 bit integers, the values are passed to snprintf as long long
+        bool longLong = false;
+        while ((*pFormat != '\0') && (strchr("hljztLq", *pFormat) != nullptr))
+        {
+            longLong = longLong || (*pFormat == 'j') || (*pFormat == 'q') || ((pFormat[0] == 'l') && (pFormat[1] == 'l'));
+            pFormat += ((pFormat[0] == 'l') && (pFormat[1] == 'l')) ? 2 : 1;
+        }
+
+        char specifier = *pFormat;
+        if (specifier != '\0')
+        {
+            ++pFormat;
+        }
+
+        int64_t integer = 0;
+        float floatingPoint = 0.0F;
+        bool truncated = false;
+
+        switch (specifier)
+        {
+            case 'd':
+            case 'i':
+                valid = valid && ReadInteger(pMessage, length, offset, integer);
+                if (valid)
+                {
+                    AppendFormatted(output, (conversion + "lld").c_str(), static_cast<long long>(integer));
+                }
+                break;
+
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                valid = valid && ReadInteger(pMessage, length, offset, integer);
+                if (valid)
+                {
+                    AppendFormatted(output, (conversion + "ll" + specifier).c_str(), ToUnsigned(integer, longLong));
+                }
+                break;
+
+            case 'c':
+                valid = valid && ReadInteger(pMessage, length, offset, integer);
+                if (valid)
+                {
+                    AppendFormatted(output, (conversion + "c").c_str(), static_cast<int>(static_cast<unsigned char>(integer)));
+                }
+                break;
+
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                valid = valid && ReadFloat(pMessage, length, offset, floatingPoint);
+                if (valid)
+                {
+                    AppendFormatted(output, (conversion + specifier).c_str(), static_cast<double>(floatingPoint));
+                }
+                break;
+
+            case 's':
+                valid = valid && ReadString(pMessage, length, offset, string, truncated);
+                if (valid)
+                {
+                    AppendFormatted(output, (conversion + "s").c_str(), string.c_str());
+                    if (truncated)
+                    {
+                        output.append("[...]");
+                    }
+                }
+                break;
+
+            case 'p':
+                valid = valid && ReadInteger(pMessage, length, offset, integer);
+                if (valid)
+                {
+                    AppendFormatted(output, "0x%llx", ToUnsigned(integer, false));
+                }
+                break;
+
+            case 'n':
+                // Nothing is written by the target
+                break;
+
+            default:
+                // An incomplete or unknown conversion
+                valid = false;
+                break;
+        }
+
+        if (!valid)
+        {
+            output.append(pPercent, static_cast<size_t>(pFormat - pPercent));
+            result = -EINVAL;
+        }
+    }
+
+    // The log format ends the line, the callers end it themselves
+    if ((output.size() > start) && (output.back() == '\n'))
+    {
+        output.pop_back();
+    }
+
+    return result;
+}
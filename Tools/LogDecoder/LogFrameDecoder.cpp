@@ -0,0 +1,262 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogFrameDecoder.hpp"
+
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+// Largest code byte, its block is not followed by a zero byte
+#define LOG_COBS_MAX_CODE   0xFF
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Decodes a base 128 varint.
+ *
+ * @param[in] pData Pointer to the bytes.
+ * @param[in] length Number of bytes.
+ * @param[in,out] offset Position of the varint, moved after it.
+ * @param[in] maxSize Largest number of bytes of the varint.
+ * @param[out] value The decoded value.
+ *
+ * @return bool Returns true on success, false if the varint is truncated or too long.
+ */
+static bool ReadVarint(const uint8_t* pData, size_t length, size_t &offset, size_t maxSize, uint64_t &value)
+{
+    value = 0;
+
+    for (size_t i = 0; (i < maxSize) && (offset < length); ++i)
+    {
+        uint8_t byte = pData[offset++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+// Public functions
+// ----------------------------------------------------------------------------
+
+LogFrameDecoder::LogFrameDecoder(Callback_t callback, void* pContext, bool crcRequired) :
+    mCallback(callback),
+    mpContext(pContext),
+    mCrcRequired(crcRequired)
+{
+    Reset();
+}
+
+void LogFrameDecoder::Decode(const uint8_t* pData, size_t length)
+{
+    const uint8_t* pEnd = pData + length;
+
+    while (pData < pEnd)
+    {
+        size_t available = static_cast<size_t>(pEnd - pData);
+
+        if (mDropping)
+        {
+            // Resynchronize on the next delimiter
+            const uint8_t* pDelimiter = static_cast<const uint8_t*>(memchr(pData, LOG_FRAME_DELIMITER, available));
+            if (pDelimiter == nullptr)
+            {
+                mStats.discardedByteCount += available;
+                return;
+            }
+
+            mStats.discardedByteCount += static_cast<size_t>(pDelimiter - pData);
+            pData = pDelimiter + 1;
+            mLength = 0;
+            mFrameByteCount = 0;
+            mCode = 0;
+            mRemaining = 0;
+            mDropping = false;
+            continue;
+        }
+
+        if (mRemaining == 0)
+        {
+            uint8_t byte = *pData++;
+            if (byte == LOG_FRAME_DELIMITER)
+            {
+                // A delimiter without any block before is an empty frame, which is ignored
+                if (mCode != 0)
+                {
+                    DecodePayload();
+                }
+
+                mLength = 0;
+                mFrameByteCount = 0;
+                mCode = 0;
+                continue;
+            }
+
+            // Every block but the largest ones stands for a zero byte after its data, unless it is the last block
+            if ((mCode != 0) && (mCode != LOG_COBS_MAX_CODE))
+            {
+                if (mLength == cMaxPayloadSize)
+                {
+                    ++mStats.overflowCount;
+                    DropFrame();
+                    continue;
+                }
+
+                mPayload[mLength++] = 0;
+            }
+
+            mCode = byte;
+            mRemaining = static_cast<uint8_t>(byte - 1);
+            ++mFrameByteCount;
+            continue;
+        }
+
+        size_t count = (available < mRemaining) ? available : mRemaining;
+        const uint8_t* pDelimiter = static_cast<const uint8_t*>(memchr(pData, LOG_FRAME_DELIMITER, count));
+        if (pDelimiter != nullptr)
+        {
+            // The frame ends in the middle of a block, it is truncated and the delimiter starts the next one
+            ++mStats.formatErrorCount;
+            mStats.discardedByteCount += mFrameByteCount + static_cast<size_t>(pDelimiter - pData);
+            pData = pDelimiter;
+            mRemaining = 0;
+            mCode = 0;
+            continue;
+        }
+
+        if (count > (cMaxPayloadSize - mLength))
+        {
+            ++mStats.overflowCount;
+            DropFrame();
+            continue;
+        }
+
+        memcpy(&mPayload[mLength], pData, count);
+        mLength += count;
+        mFrameByteCount += count;
+        mRemaining = static_cast<uint8_t>(mRemaining - count);
+        pData += count;
+    }
+}
+
+void LogFrameDecoder::Finish()
+{
+    // The bytes of a frame already dropped are counted
+    if (!mDropping)
+    {
+        mStats.discardedByteCount += mFrameByteCount;
+    }
+
+    mLength = 0;
+    mFrameByteCount = 0;
+    mCode = 0;
+    mRemaining = 0;
+    mDropping = false;
+}
+
+void LogFrameDecoder::Reset()
+{
+    mLength = 0;
+    mFrameByteCount = 0;
+    mCode = 0;
+    mRemaining = 0;
+    mDropping = false;
+    mSequenceNumberValid = false;
+    mLastSequenceNumber = 0;
+    mStats = {};
+}
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+void LogFrameDecoder::DecodePayload()
+{
+    LogFrameRecord_t record = {};
+    size_t length = mLength;
+    size_t offset = 1;
+    uint64_t value = 0;
+
+    // The header byte and the sequence number are always present
+    bool valid = (length >= 2) && ((mPayload[0] & LOG_FRAME_RESERVED_MASK) == 0);
+
+    if (valid && ((mPayload[0] & LOG_FRAME_CRC_FLAG) == 0))
+    {
+        valid = !mCrcRequired;
+    }
+    else if (valid)
+    {
+        if (length < (2 + LOG_FRAME_CRC_SIZE))
+        {
+            valid = false;
+        }
+        else
+        {
+            length -= LOG_FRAME_CRC_SIZE;
+
+            uint16_t crc = static_cast<uint16_t>(mPayload[length] | (mPayload[length + 1] << 8));
+            if (LogFrame_UpdateCrc(LOG_FRAME_CRC_INITIAL_VALUE, mPayload, length) != crc)
+            {
+                ++mStats.crcErrorCount;
+                mStats.discardedByteCount += mFrameByteCount;
+                return;
+            }
+        }
+    }
+
+    if (valid)
+    {
+        valid = ReadVarint(mPayload, length, offset, LOG_FRAME_MAX_SEQUENCE_NUMBER_SIZE, value) && (value <= UINT32_MAX);
+        record.sequenceNumber = static_cast<uint32_t>(value);
+    }
+
+    if (valid && ((mPayload[0] & LOG_FRAME_TIMESTAMP_FLAG) != 0))
+    {
+        valid = ReadVarint(mPayload, length, offset, LOG_FRAME_MAX_TIMESTAMP_SIZE, value);
+        record.hasTimestamp = true;
+        record.timestamp = value;
+    }
+
+    if (!valid)
+    {
+        ++mStats.formatErrorCount;
+        mStats.discardedByteCount += mFrameByteCount;
+        return;
+    }
+
+    record.level = mPayload[0] & LOG_FRAME_LEVEL_MASK;
+    record.pMessage = &mPayload[offset];
+    record.length = length - offset;
+
+    if (mSequenceNumberValid && (record.sequenceNumber != (mLastSequenceNumber + 1)))
+    {
+        ++mStats.sequenceGapCount;
+    }
+    mSequenceNumberValid = true;
+    mLastSequenceNumber = record.sequenceNumber;
+
+    ++mStats.frameCount;
+    mCallback(record, mpContext);
+}
+
+void LogFrameDecoder::DropFrame()
+{
+    mStats.discardedByteCount += mFrameByteCount;
+    mDropping = true;
+}
@@ -0,0 +1,280 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogStreamDecoder.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+// Prefix of the Base64 encoded log messages
+#define LOG_BASE64_PREFIX           '$'
+
+// Value of the characters which are not Base64
+#define LOG_BASE64_INVALID          0xFF
+
+// Longest line kept across Decode() calls, a longer line is decoded in parts
+#define LOG_STREAM_MAX_LINE_LENGTH  (64 * 1024)
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Gets the value of a Base64 character.
+ *
+ * @param[in] character The character.
+ *
+ * @return uint8_t The value of 6 bits, or LOG_BASE64_INVALID for the other characters, padding included.
+ */
+static inline uint8_t GetBase64Value(char character)
+{
+    if ((character >= 'A') && (character <= 'Z'))
+    {
+        return static_cast<uint8_t>(character - 'A');
+    }
+    if ((character >= 'a') && (character <= 'z'))
+    {
+        return static_cast<uint8_t>(character - 'a' + 26);
+    }
+    if ((character >= '0') && (character <= '9'))
+    {
+        return static_cast<uint8_t>(character - '0' + 52);
+    }
+    if (character == '+')
+    {
+        return 62;
+    }
+    if (character == '/')
+    {
+        return 63;
+    }
+
+    return LOG_BASE64_INVALID;
+}
+
+/**
+ * @brief Decodes Base64 characters, without their padding.
+ *
+ * @param[in] pEncoded Pointer to the characters, all valid.
+ * @param[in] length Number of characters, not 1 more than a multiple of 4.
+ * @param[out] decoded The decoded bytes.
+ */
+static void DecodeBase64(const char* pEncoded, size_t length, std::vector<uint8_t> &decoded)
+{
+    decoded.clear();
+
+    uint32_t bits = 0;
+    size_t bitCount = 0;
+    for (size_t i = 0; i < length; ++i)
+    {
+        bits = (bits << 6) | GetBase64Value(pEncoded[i]);
+        bitCount += 6;
+        if (bitCount >= 8)
+        {
+            bitCount -= 8;
+            decoded.push_back(static_cast<uint8_t>(bits >> bitCount));
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Public functions
+// ----------------------------------------------------------------------------
+
+LogStreamDecoder::LogStreamDecoder(const LogTokenDatabase &database, LogStreamFormat_t format, bool crcRequired,
+                                   uint64_t timestampFrequency) :
+    mDetokenizer(database),
+    mFormat(format),
+    mTimestampFrequency(timestampFrequency),
+    mFrameDecoder(HandleFrame, this, crcRequired),
+    mpOutput(nullptr),
+    mStats()
+{
+}
+
+void LogStreamDecoder::Decode(const uint8_t* pData, size_t length, std::string &output)
+{
+    if (mFormat == LOG_STREAM_FORMAT_FRAMED)
+    {
+        mpOutput = &output;
+        mFrameDecoder.Decode(pData, length);
+        mpOutput = nullptr;
+        return;
+    }
+
+    const char* pText = reinterpret_cast<const char*>(pData);
+    const char* pEnd = pText + length;
+
+    while (pText < pEnd)
+    {
+        const char* pLineEnd = static_cast<const char*>(memchr(pText, '\n', static_cast<size_t>(pEnd - pText)));
+        if (pLineEnd == nullptr)
+        {
+            // The line continues in the next bytes
+            mLine.append(pText, static_cast<size_t>(pEnd - pText));
+            if (mLine.size() > LOG_STREAM_MAX_LINE_LENGTH)
+            {
+                DecodeLine(mLine.data(), mLine.size(), output);
+                mLine.clear();
+            }
+            return;
+        }
+
+        ++pLineEnd;
+        if (mLine.empty())
+        {
+            DecodeLine(pText, static_cast<size_t>(pLineEnd - pText), output);
+        }
+        else
+        {
+            mLine.append(pText, static_cast<size_t>(pLineEnd - pText));
+            DecodeLine(mLine.data(), mLine.size(), output);
+            mLine.clear();
+        }
+
+        pText = pLineEnd;
+    }
+}
+
+void LogStreamDecoder::Finish(std::string &output)
+{
+    // A partial frame is dropped, it cannot be completed anymore
+    if (mFormat == LOG_STREAM_FORMAT_FRAMED)
+    {
+        mFrameDecoder.Finish();
+        return;
+    }
+
+    if (!mLine.empty())
+    {
+        DecodeLine(mLine.data(), mLine.size(), output);
+        mLine.clear();
+    }
+}
+
+LogStreamStats_t LogStreamDecoder::GetStats() const
+{
+    LogStreamStats_t stats = mStats;
+    stats.frames = mFrameDecoder.GetStats();
+
+    return stats;
+}
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+void LogStreamDecoder::HandleFrame(const LogFrameRecord_t &record, void* pContext)
+{
+    LogStreamDecoder* pDecoder = static_cast<LogStreamDecoder*>(pContext);
+    std::string &output = *pDecoder->mpOutput;
+    char text[64];
+    int length = 0;
+
+    if (record.hasTimestamp && (pDecoder->mTimestampFrequency > 0))
+    {
+        uint64_t frequency = pDecoder->mTimestampFrequency;
+        length = snprintf(text, sizeof(text), "%llu.%06llu ", static_cast<unsigned long long>(record.timestamp / frequency),
+                          static_cast<unsigned long long>(((record.timestamp % frequency) * 1000000) / frequency));
+    }
+    else if (record.hasTimestamp)
+    {
+        length = snprintf(text, sizeof(text), "%llu ", static_cast<unsigned long long>(record.timestamp));
+    }
+    output.append(text, static_cast<size_t>(length));
+
+    int result = pDecoder->DetokenizeMessage(record.pMessage, record.length, output);
+    if (result == -ENOENT)
+    {
+        length = snprintf(text, sizeof(text), "[unknown token 0x%02X%02X%02X%02X]",
+                          record.pMessage[3], record.pMessage[2], record.pMessage[1], record.pMessage[0]);
+        output.append(text, static_cast<size_t>(length));
+    }
+    else if (result == -EMSGSIZE)
+    {
+        output.append("[log message without token]");
+    }
+
+    output.push_back('\n');
+}
+
+void LogStreamDecoder::DecodeLine(const char* pLine, size_t length, std::string &output)
+{
+    const char* pEnd = pLine + length;
+
+    while (pLine < pEnd)
+    {
+        const char* pPrefix = static_cast<const char*>(memchr(pLine, LOG_BASE64_PREFIX, static_cast<size_t>(pEnd - pLine)));
+        if (pPrefix == nullptr)
+        {
+            output.append(pLine, static_cast<size_t>(pEnd - pLine));
+            return;
+        }
+
+        output.append(pLine, static_cast<size_t>(pPrefix - pLine));
+
+        const char* pEncoded = pPrefix + 1;
+        const char* pEncodedEnd = pEncoded;
+        while ((pEncodedEnd < pEnd) && (GetBase64Value(*pEncodedEnd) != LOG_BASE64_INVALID))
+        {
+            ++pEncodedEnd;
+        }
+
+        size_t encodedLength = static_cast<size_t>(pEncodedEnd - pEncoded);
+        size_t paddedLength = encodedLength;
+        while ((pEncoded + paddedLength < pEnd) && (pEncoded[paddedLength] == '=') && ((paddedLength % 4) != 0))
+        {
+            ++paddedLength;
+        }
+
+        pLine = pEncoded + paddedLength;
+
+        // A single character of a block does not make a byte
+        if ((encodedLength % 4) != 1)
+        {
+            DecodeBase64(pEncoded, encodedLength, mMessage);
+
+            int result = DetokenizeMessage(mMessage.data(), mMessage.size(), output);
+            if ((result == 0) || (result == -EINVAL))
+            {
+                continue;
+            }
+        }
+
+        // Kept as is, eg: a '$' in the text, or a token of another database
+        output.append(pPrefix, static_cast<size_t>(pLine - pPrefix));
+    }
+}
+
+int LogStreamDecoder::DetokenizeMessage(const uint8_t* pMessage, size_t length, std::string &output)
+{
+    int result = mDetokenizer.Detokenize(pMessage, length, output);
+
+    if (result == -ENOENT)
+    {
+        ++mStats.unknownTokenCount;
+    }
+    else if (result == -EINVAL)
+    {
+        ++mStats.argumentErrorCount;
+    }
+
+    if ((result == 0) || (result == -EINVAL))
+    {
+        ++mStats.messageCount;
+    }
+
+    return result;
+}
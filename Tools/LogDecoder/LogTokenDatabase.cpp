@@ -0,0 +1,236 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogTokenDatabase.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+// Number of hexadecimal digits of a token
+#define LOG_TOKEN_MAX_DIGITS    8
+
+// ----------------------------------------------------------------------------
+// Public functions
+// ----------------------------------------------------------------------------
+
+int LogTokenDatabase::Load(const char* pPath)
+{
+    FILE* pFile = fopen(pPath, "rb");
+    if (pFile == nullptr)
+    {
+        return -errno;
+    }
+
+    std::vector<char> text;
+    char buffer[64 * 1024];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+    {
+        text.insert(text.end(), buffer, buffer + length);
+    }
+
+    int result = ferror(pFile) ? -EIO : 0;
+    fclose(pFile);
+
+    if (result == 0)
+    {
+        result = Parse(text.data(), text.size());
+    }
+
+    return result;
+}
+
+int LogTokenDatabase::Parse(const char* pText, size_t length)
+{
+    std::vector<std::string> fields(1);
+    size_t fieldCount = 1;
+    bool quoted = false;
+    int result = 0;
+
+    for (size_t i = 0; (i <= length) && (result == 0); ++i)
+    {
+        // The end of the text ends the last line
+        char character = (i < length) ? pText[i] : '\n';
+
+        if (quoted)
+        {
+            if (character != '"')
+            {
+                fields[fieldCount - 1].push_back(character);
+            }
+            else if (((i + 1) < length) && (pText[i + 1] == '"'))
+            {
+                // A quote is doubled within a quoted field
+                fields[fieldCount - 1].push_back('"');
+                ++i;
+            }
+            else
+            {
+                quoted = false;
+            }
+        }
+        else if (character == '"')
+        {
+            quoted = true;
+        }
+        else if (character == ',')
+        {
+            if (fieldCount == fields.size())
+            {
+                fields.emplace_back();
+            }
+            fields[fieldCount++].clear();
+        }
+        else if (character == '\n')
+        {
+            // Empty lines are skipped
+            if ((fieldCount > 1) || !fields[0].empty())
+            {
+                result = AddLine(fields, fieldCount);
+            }
+
+            fields[0].clear();
+            fieldCount = 1;
+        }
+        else if (character != '\r')
+        {
+            fields[fieldCount - 1].push_back(character);
+        }
+    }
+
+    if (quoted)
+    {
+        // The last string is not terminated
+        result = -EINVAL;
+    }
+
+    Build();
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+int LogTokenDatabase::AddLine(const std::vector<std::string> &fields, size_t fieldCount)
+{
+    // Token, removal date, and the string as last field, with or without the domain before it
+    if (fieldCount < 3)
+    {
+        return -EINVAL;
+    }
+
+    uint32_t token = 0;
+    size_t digitCount = 0;
+    for (char character : fields[0])
+    {
+        if (character == ' ')
+        {
+            continue;
+        }
+
+        uint32_t digit;
+        if ((character >= '0') && (character <= '9'))
+        {
+            digit = static_cast<uint32_t>(character - '0');
+        }
+        else if ((character >= 'a') && (character <= 'f'))
+        {
+            digit = static_cast<uint32_t>(character - 'a' + 10);
+        }
+        else if ((character >= 'A') && (character <= 'F'))
+        {
+            digit = static_cast<uint32_t>(character - 'A' + 10);
+        }
+        else
+        {
+            return -EINVAL;
+        }
+
+        if (++digitCount > LOG_TOKEN_MAX_DIGITS)
+        {
+            return -EINVAL;
+        }
+        token = (token << 4) | digit;
+    }
+
+    const std::string &string = fields[fieldCount - 1];
+    if ((digitCount == 0) || ((mStrings.size() + string.size() + 1) >= UINT32_MAX))
+    {
+        return -EINVAL;
+    }
+
+    // The removal date is blank while the string is still in the firmware
+    bool removed = (fields[1].find_first_not_of(' ') != std::string::npos);
+
+    mTokenStrings.push_back({ .token = token, .stringOffset = static_cast<uint32_t>(mStrings.size()), .removed = removed });
+    mStrings.insert(mStrings.end(), string.begin(), string.end());
+    mStrings.push_back('\0');
+
+    return 0;
+}
+
+void LogTokenDatabase::Build()
+{
+    // The table is at most half full, so that a lookup probes few slots
+    size_t capacity = 2;
+    mShift = 1;
+    while (capacity < (mTokenStrings.size() * 2))
+    {
+        capacity *= 2;
+        ++mShift;
+    }
+
+    mEntries.assign(capacity, { .token = 0, .stringOffset = UINT32_MAX });
+    std::vector<bool> removedSlots(capacity, false);
+    mCount = 0;
+    mCollisionCount = 0;
+
+    size_t mask = capacity - 1;
+    for (const LogTokenString_t &tokenString : mTokenStrings)
+    {
+        size_t i = Hash(tokenString.token);
+        while ((mEntries[i].stringOffset != UINT32_MAX) && (mEntries[i].token != tokenString.token))
+        {
+            i = (i + 1) & mask;
+        }
+
+        LogTokenEntry_t &entry = mEntries[i];
+        if (entry.stringOffset == UINT32_MAX)
+        {
+            entry = { .token = tokenString.token, .stringOffset = tokenString.stringOffset };
+            removedSlots[i] = tokenString.removed;
+            ++mCount;
+            continue;
+        }
+
+        if (strcmp(&mStrings[entry.stringOffset], &mStrings[tokenString.stringOffset]) == 0)
+        {
+            // The same string from another database
+            removedSlots[i] = removedSlots[i] && tokenString.removed;
+        }
+        else
+        {
+            ++mCollisionCount;
+
+            // A string still in the firmware wins over a removed one
+            if (removedSlots[i] && !tokenString.removed)
+            {
+                entry.stringOffset = tokenString.stringOffset;
+                removedSlots[i] = false;
+            }
+        }
+    }
+}
@@ -0,0 +1,390 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogStreamDecoder.hpp"
+#include "LogTokenDatabase.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+// Bytes of a capture file decoded by a thread at once, the outputs of a round are written in order
+#define DETOKENIZE_CHUNK_SIZE       (16 * 1024 * 1024)
+
+// Bytes read at once from a stream which cannot be mapped, eg: a pipe or a serial port
+#define DETOKENIZE_READ_SIZE        (64 * 1024)
+
+// ----------------------------------------------------------------------------
+// Datatype definitions
+// ----------------------------------------------------------------------------
+
+// Options of the command line
+typedef struct
+{
+    LogStreamFormat_t   format;                 // Format of the capture
+    bool                crcRequired;            // Every frame must carry a CRC
+    uint64_t            timestampFrequency;     // Frequency of the log clock of the target, 0 to print ticks
+    size_t              threadCount;            // Number of decoding threads for a capture file
+    bool                printStats;             // Print the statistics of the capture on the standard error
+} DetokenizeOptions_t;
+
+// Part of a capture file decoded by a thread
+typedef struct
+{
+    const uint8_t*      pData;                  // Pointer to the part, it starts at a line or a frame
+    size_t              length;                 // Length of the part, it ends after a line end or a delimiter
+    std::string         output;                 // Text of the part
+    LogStreamStats_t    stats;                  // Statistics of the part
+} DetokenizeChunk_t;
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Prints the usage of the command.
+ *
+ * @param[in] pName Name of the command.
+ */
+static void PrintUsage(const char* pName)
+{
+    fprintf(stderr,
+            "Usage: %s -d <database.csv> [options] [capture]\n"
+            "Detokenizes a log capture, or the standard input without capture file.\n"
+            "\n"
+            "  -d <database.csv>   Token database created by pw_tokenizer database.py, may be repeated\n"
+            "  -f <format>         Format of the capture: base64 (default) or framed\n"
+            "  -j <threads>        Number of decoding threads for a capture file, all the cores by default\n"
+            "  -t <frequency>      Frequency of the log clock in Hz, to print the timestamps of the frames in seconds\n"
+            "  -n                  Accept the frames without CRC, for CONFIG_COMMONS_LOGGING_FRAMING_CRC=n\n"
+            "  -s                  Print the statistics of the capture on the standard error\n",
+            pName);
+}
+
+/**
+ * @brief Adds the statistics of a part of the capture to the totals.
+ *
+ * @param[in,out] total The statistics of the capture.
+ * @param[in] stats The statistics of the part.
+ */
+static void AddStats(LogStreamStats_t &total, const LogStreamStats_t &stats)
+{
+    total.messageCount += stats.messageCount;
+    total.unknownTokenCount += stats.unknownTokenCount;
+    total.argumentErrorCount += stats.argumentErrorCount;
+    total.frames.frameCount += stats.frames.frameCount;
+    total.frames.crcErrorCount += stats.frames.crcErrorCount;
+    total.frames.formatErrorCount += stats.frames.formatErrorCount;
+    total.frames.overflowCount += stats.frames.overflowCount;
+    total.frames.sequenceGapCount += stats.frames.sequenceGapCount;
+    total.frames.discardedByteCount += stats.frames.discardedByteCount;
+}
+
+/**
+ * @brief Writes text to the standard output.
+ *
+ * @param[in] text The text.
+ *
+ * @return int Returns 0 on success, or -errno on failure.
+ */
+static int WriteOutput(const std::string &text)
+{
+    if (fwrite(text.data(), 1, text.size(), stdout) != text.size())
+    {
+        return -errno;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Detokenizes a stream which cannot be mapped, as it comes.
+ *
+ * @param[in] fd File descriptor of the stream.
+ * @param[in] database The token database.
+ * @param[in] options The options of the command line.
+ * @param[out] stats The statistics of the stream.
+ *
+ * @return int Returns 0 on success, or -errno on failure.
+ */
+static int DetokenizeStream(int fd, const LogTokenDatabase &database, const DetokenizeOptions_t &options,
+                            LogStreamStats_t &stats)
+{
+    LogStreamDecoder decoder(database, options.format, options.crcRequired, options.timestampFrequency);
+    std::vector<uint8_t> buffer(DETOKENIZE_READ_SIZE);
+    std::string output;
+    int result = 0;
+
+    while (result == 0)
+    {
+        ssize_t length = read(fd, buffer.data(), buffer.size());
+        if ((length < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        if (length <= 0)
+        {
+            result = (length < 0) ? -errno : 0;
+            break;
+        }
+
+        decoder.Decode(buffer.data(), static_cast<size_t>(length), output);
+        result = WriteOutput(output);
+        output.clear();
+
+        // The output follows the stream live, eg: from a serial port
+        fflush(stdout);
+    }
+
+    decoder.Finish(output);
+    if (result == 0)
+    {
+        result = WriteOutput(output);
+    }
+
+    AddStats(stats, decoder.GetStats());
+    return result;
+}
+
+/**
+ * @brief Detokenizes a mapped capture file, in parallel.
+ *
+ * The file is decoded in rounds of one chunk per thread. Every chunk is extended to the next line end,
+ * or frame delimiter, so that it is decoded on its own. The sequence gaps between chunks are not counted.
+ *
+ * @param[in] pData Pointer to the content of the file.
+ * @param[in] length Length of the file.
+ * @param[in] database The token database.
+ * @param[in] options The options of the command line.
+ * @param[out] stats The statistics of the file.
+ *
+ * @return int Returns 0 on success, or -errno on failure.
+ */
+static int DetokenizeFile(const uint8_t* pData, size_t length, const LogTokenDatabase &database,
+                          const DetokenizeOptions_t &options, LogStreamStats_t &stats)
+{
+    uint8_t separator = (options.format == LOG_STREAM_FORMAT_FRAMED) ? LOG_FRAME_DELIMITER : '\n';
+    std::vector<DetokenizeChunk_t> chunks(options.threadCount);
+    std::vector<std::thread> threads;
+    size_t offset = 0;
+    int result = 0;
+
+    while ((offset < length) && (result == 0))
+    {
+        size_t chunkCount = 0;
+        for (; (chunkCount < chunks.size()) && (offset < length); ++chunkCount)
+        {
+            size_t end = ((length - offset) > DETOKENIZE_CHUNK_SIZE) ? (offset + DETOKENIZE_CHUNK_SIZE) : length;
+            const uint8_t* pSeparator = static_cast<const uint8_t*>(memchr(&pData[end - 1], separator, length - end + 1));
+            end = (pSeparator != nullptr) ? static_cast<size_t>(pSeparator - pData) + 1 : length;
+
+            chunks[chunkCount].pData = &pData[offset];
+            chunks[chunkCount].length = end - offset;
+            chunks[chunkCount].output.clear();
+            offset = end;
+        }
+
+        threads.clear();
+        for (size_t i = 0; i < chunkCount; ++i)
+        {
+            threads.emplace_back([&database, &options](DetokenizeChunk_t* pChunk)
+            {
+                LogStreamDecoder decoder(database, options.format, options.crcRequired, options.timestampFrequency);
+
+                decoder.Decode(pChunk->pData, pChunk->length, pChunk->output);
+                decoder.Finish(pChunk->output);
+                pChunk->stats = decoder.GetStats();
+            }, &chunks[i]);
+        }
+
+        for (size_t i = 0; i < chunkCount; ++i)
+        {
+            threads[i].join();
+            if (result == 0)
+            {
+                result = WriteOutput(chunks[i].output);
+            }
+            AddStats(stats, chunks[i].stats);
+        }
+    }
+
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+// Main function
+// ----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    DetokenizeOptions_t options = { .format             = LOG_STREAM_FORMAT_BASE64,
+                                    .crcRequired        = true,
+                                    .timestampFrequency = 0,
+                                    .threadCount        = std::thread::hardware_concurrency(),
+                                    .printStats         = false };
+    LogTokenDatabase database;
+    bool databaseLoaded = false;
+    int option;
+
+    while ((option = getopt(argc, argv, "d:f:j:t:nsh")) != -1)
+    {
+        switch (option)
+        {
+            case 'd':
+            {
+                int result = database.Load(optarg);
+                if (result != 0)
+                {
+                    fprintf(stderr, "Cannot load the token database %s: %s\n", optarg, strerror(-result));
+                    return EXIT_FAILURE;
+                }
+                databaseLoaded = true;
+                break;
+            }
+
+            case 'f':
+                if (strcmp(optarg, "base64") == 0)
+                {
+                    options.format = LOG_STREAM_FORMAT_BASE64;
+                }
+                else if (strcmp(optarg, "framed") == 0)
+                {
+                    options.format = LOG_STREAM_FORMAT_FRAMED;
+                }
+                else
+                {
+                    PrintUsage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case 'j':
+                options.threadCount = strtoul(optarg, nullptr, 0);
+                break;
+
+            case 't':
+                options.timestampFrequency = strtoull(optarg, nullptr, 0);
+                break;
+
+            case 'n':
+                options.crcRequired = false;
+                break;
+
+            case 's':
+                options.printStats = true;
+                break;
+
+            default:
+                PrintUsage(argv[0]);
+                return (option == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (!databaseLoaded || ((argc - optind) > 1))
+    {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (options.threadCount == 0)
+    {
+        options.threadCount = 1;
+    }
+
+    int fd = STDIN_FILENO;
+    if (optind < argc)
+    {
+        fd = open(argv[optind], O_RDONLY);
+        if (fd < 0)
+        {
+            fprintf(stderr, "Cannot open %s: %s\n", argv[optind], strerror(errno));
+            return EXIT_FAILURE;
+        }
+    }
+
+    LogStreamStats_t stats = {};
+    int result;
+
+    // A regular file is mapped and decoded in parallel, anything else is decoded as it comes
+    struct stat fileStatus;
+    void* pMapping = MAP_FAILED;
+    if ((fstat(fd, &fileStatus) == 0) && S_ISREG(fileStatus.st_mode) && (fileStatus.st_size > 0))
+    {
+        pMapping = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    if (pMapping != MAP_FAILED)
+    {
+        madvise(pMapping, static_cast<size_t>(fileStatus.st_size), MADV_SEQUENTIAL);
+        result = DetokenizeFile(static_cast<const uint8_t*>(pMapping), static_cast<size_t>(fileStatus.st_size),
+                                database, options, stats);
+        munmap(pMapping, static_cast<size_t>(fileStatus.st_size));
+    }
+    else
+    {
+        result = DetokenizeStream(fd, database, options, stats);
+    }
+
+    if (fd != STDIN_FILENO)
+    {
+        close(fd);
+    }
+
+    if ((fflush(stdout) != 0) && (result == 0))
+    {
+        result = -errno;
+    }
+
+    if (options.printStats)
+    {
+        fprintf(stderr,
+                "tokens: %zu (%zu collisions)\n"
+                "messages: %llu, unknown tokens: %llu, argument errors: %llu\n",
+                database.GetCount(), database.GetCollisionCount(),
+                static_cast<unsigned long long>(stats.messageCount),
+                static_cast<unsigned long long>(stats.unknownTokenCount),
+                static_cast<unsigned long long>(stats.argumentErrorCount));
+
+        if (options.format == LOG_STREAM_FORMAT_FRAMED)
+        {
+            fprintf(stderr,
+                    "frames: %llu, crc errors: %llu, format errors: %llu, overflows: %llu, sequence gaps: %llu, "
+                    "discarded bytes: %llu\n",
+                    static_cast<unsigned long long>(stats.frames.frameCount),
+                    static_cast<unsigned long long>(stats.frames.crcErrorCount),
+                    static_cast<unsigned long long>(stats.frames.formatErrorCount),
+                    static_cast<unsigned long long>(stats.frames.overflowCount),
+                    static_cast<unsigned long long>(stats.frames.sequenceGapCount),
+                    static_cast<unsigned long long>(stats.frames.discardedByteCount));
+        }
+    }
+
+    if (result != 0)
+    {
+        fprintf(stderr, "Cannot detokenize the capture: %s\n", strerror(-result));
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,344 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "Assert.h"
+#include "LogFrame.hpp"
+#include "LogFrameDecoder.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+// Counts a failed check and tells where it is, the test goes on with the next checks
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition))                                                       \
+        {                                                                       \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++gFailureCount;                                                    \
+        }                                                                       \
+    } while (false)
+
+// ----------------------------------------------------------------------------
+// Datatype definitions
+// ----------------------------------------------------------------------------
+
+// Log message received by the callback of the decoder, with a copy of its bytes
+typedef struct
+{
+    int                     level;
+    uint32_t                sequenceNumber;
+    bool                    hasTimestamp;
+    uint64_t                timestamp;
+    std::vector<uint8_t>    message;
+} DecodedRecord_t;
+
+// ----------------------------------------------------------------------------
+// Variable definitions
+// ----------------------------------------------------------------------------
+
+// Number of failed checks
+static int gFailureCount = 0;
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Keeps a decoded log message, the record only points to the decoder.
+ *
+ * @param[in] record The decoded log message.
+ * @param[in] pContext The vector receiving the log messages.
+ */
+static void OnRecord(const LogFrameRecord_t& record, void* pContext)
+{
+    std::vector<DecodedRecord_t>* pRecords = static_cast<std::vector<DecodedRecord_t>*>(pContext);
+    pRecords->push_back({ .level          = record.level,
+                          .sequenceNumber = record.sequenceNumber,
+                          .hasTimestamp   = record.hasTimestamp,
+                          .timestamp      = record.timestamp,
+                          .message        = std::vector<uint8_t>(record.pMessage, record.pMessage + record.length) });
+}
+
+/**
+ * @brief Frames a log message, split in two segments to go through the segmented path of the encoder.
+ *
+ * @param[in] message The log message.
+ * @param[in] level The level of the log message.
+ * @param[in] sequenceNumber The sequence number of the log message.
+ *
+ * @return std::vector<uint8_t> The frame, delimiter included, empty if it does not fit.
+ */
+static std::vector<uint8_t> EncodeFrame(const std::vector<uint8_t>& message, int level, uint32_t sequenceNumber)
+{
+    size_t firstLength = message.size() / 2;
+    LogRecord_t record = {};
+    record.segments[0] = { .pData = message.data(), .length = firstLength };
+    record.segments[1] = { .pData = message.data() + firstLength, .length = message.size() - firstLength };
+    record.segmentCount = 2;
+    record.level = level;
+    record.sequenceNumber = sequenceNumber;
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    record.timestamp = 1000000ULL + sequenceNumber;
+#endif
+
+    std::vector<uint8_t> frame(LogFrame::cFrameSize);
+    frame.resize(LogFrame::Encode(record, frame.data(), frame.size()));
+    return frame;
+}
+
+/**
+ * @brief Checks that a decoded log message is the one which was framed.
+ *
+ * @param[in] decoded The decoded log message.
+ * @param[in] message The framed log message.
+ * @param[in] level The level of the framed log message.
+ * @param[in] sequenceNumber The sequence number of the framed log message.
+ */
+static void CheckRecord(const DecodedRecord_t& decoded, const std::vector<uint8_t>& message, int level, uint32_t sequenceNumber)
+{
+    CHECK(decoded.level == level);
+    CHECK(decoded.sequenceNumber == sequenceNumber);
+    CHECK(decoded.message == message);
+#if CONFIG_COMMONS_LOGGING_TIMESTAMP
+    CHECK(decoded.hasTimestamp);
+    CHECK(decoded.timestamp == (1000000ULL + sequenceNumber));
+#else
+    CHECK(!decoded.hasTimestamp);
+#endif
+}
+
+/**
+ * @brief Frames log messages of every length with zero bytes at every position, and decodes them one byte at a time.
+ */
+static void TestRoundTrip()
+{
+    std::vector<DecodedRecord_t> records;
+    LogFrameDecoder decoder(OnRecord, &records, CONFIG_COMMONS_LOGGING_FRAMING_CRC);
+    std::vector<std::vector<uint8_t>> messages;
+
+    for (size_t length = 1; length <= CONFIG_COMMONS_LOGGING_BUFFER_SIZE; ++length)
+    {
+        std::vector<uint8_t> message(length);
+        for (size_t i = 0; i < length; ++i)
+        {
+            message[i] = ((i % 7) == (length % 7)) ? 0 : static_cast<uint8_t>(i + length);
+        }
+
+        std::vector<uint8_t> frame = EncodeFrame(message, static_cast<int>(length % 6), static_cast<uint32_t>(length));
+        CHECK(!frame.empty());
+        CHECK(frame.size() <= LogFrame::cFrameSize);
+        CHECK(memchr(frame.data(), LOG_FRAME_DELIMITER, frame.size() - 1) == nullptr);
+        CHECK(frame.back() == LOG_FRAME_DELIMITER);
+
+        for (uint8_t byte : frame)
+        {
+            decoder.Decode(&byte, 1);
+        }
+        messages.push_back(message);
+    }
+
+    CHECK(records.size() == messages.size());
+    for (size_t i = 0; (i < records.size()) && (i < messages.size()); ++i)
+    {
+        CheckRecord(records[i], messages[i], static_cast<int>((i + 1) % 6), static_cast<uint32_t>(i + 1));
+    }
+
+    const LogFrameDecoderStats_t& stats = decoder.GetStats();
+    CHECK(stats.frameCount == messages.size());
+    CHECK(stats.crcErrorCount == 0);
+    CHECK(stats.formatErrorCount == 0);
+    CHECK(stats.sequenceGapCount == 0);
+    CHECK(stats.discardedByteCount == 0);
+}
+
+/**
+ * @brief Frames a payload of exactly 254 non zero bytes, the longest COBS block, followed by an empty block.
+ */
+static void TestFullBlock()
+{
+    // The header takes the level byte, the sequence number and the timestamp, and the CRC follows the message
+    std::vector<uint8_t> probe = EncodeFrame({ 'x' }, 1, 1);
+    size_t overhead = probe.size() - 2 - 1;
+
+    // The last byte is chosen so that the CRC has no zero byte, then the whole payload has none
+    std::vector<uint8_t> frame;
+    std::vector<uint8_t> message(254 - overhead, 'a');
+    for (int last = 1; last < 256; ++last)
+    {
+        message.back() = static_cast<uint8_t>(last);
+        frame = EncodeFrame(message, 1, 1);
+        if (frame.size() == (1 + 254 + 1 + 1))
+        {
+            break;
+        }
+    }
+
+    CHECK(message.size() <= CONFIG_COMMONS_LOGGING_BUFFER_SIZE);
+    CHECK(frame.size() == (1 + 254 + 1 + 1));
+    CHECK(frame.size() == LOG_FRAME_ENCODED_SIZE(254));
+    CHECK(frame[0] == 0xFF);
+    CHECK(frame[255] == 0x01);
+
+    std::vector<DecodedRecord_t> records;
+    LogFrameDecoder decoder(OnRecord, &records, CONFIG_COMMONS_LOGGING_FRAMING_CRC);
+    decoder.Decode(frame.data(), frame.size());
+
+    CHECK(records.size() == 1);
+    if (records.size() == 1)
+    {
+        CheckRecord(records[0], message, 1, 1);
+    }
+}
+
+#if CONFIG_COMMONS_LOGGING_FRAMING_CRC
+/**
+ * @brief Corrupts a frame, which is dropped for its CRC while the next frame is decoded.
+ */
+static void TestBadCrc()
+{
+    std::vector<uint8_t> message = { 'h', 'e', 'l', 'l', 'o' };
+    std::vector<uint8_t> frame = EncodeFrame(message, 2, 10);
+    std::vector<uint8_t> corrupted = frame;
+
+    // A message byte is changed, without adding a zero byte which would split the frame
+    uint8_t* pByte = static_cast<uint8_t*>(memchr(corrupted.data(), 'l', corrupted.size()));
+    CHECK(pByte != nullptr);
+    if (pByte != nullptr)
+    {
+        *pByte = 'L';
+    }
+
+    std::vector<DecodedRecord_t> records;
+    LogFrameDecoder decoder(OnRecord, &records, true);
+    decoder.Decode(corrupted.data(), corrupted.size());
+    std::vector<uint8_t> next = EncodeFrame(message, 2, 11);
+    decoder.Decode(next.data(), next.size());
+
+    CHECK(records.size() == 1);
+    if (records.size() == 1)
+    {
+        CheckRecord(records[0], message, 2, 11);
+    }
+
+    const LogFrameDecoderStats_t& stats = decoder.GetStats();
+    CHECK(stats.crcErrorCount == 1);
+    CHECK(stats.frameCount == 1);
+    CHECK(stats.discardedByteCount == (corrupted.size() - 1));
+}
+#endif
+
+/**
+ * @brief Starts decoding in the middle of a frame and after garbage, the decoder resynchronizes on the next delimiter.
+ */
+static void TestResync()
+{
+    std::vector<uint8_t> message = { 't', 0, 'o', 'k', 0, 0, 'e', 'n' };
+    std::vector<uint8_t> first = EncodeFrame(message, 3, 20);
+    std::vector<uint8_t> second = EncodeFrame(message, 4, 21);
+    std::vector<uint8_t> third = EncodeFrame(message, 5, 22);
+
+    // The end of a frame, garbage which looks like a block longer than the rest of the frame, and two frames
+    std::vector<uint8_t> stream(first.begin() + (first.size() / 2), first.end());
+    stream.insert(stream.end(), { 0x40, 0x01, 0x02, 0x03 });
+    stream.push_back(LOG_FRAME_DELIMITER);
+    stream.insert(stream.end(), second.begin(), second.end());
+    stream.insert(stream.end(), third.begin(), third.end());
+
+    std::vector<DecodedRecord_t> records;
+    LogFrameDecoder decoder(OnRecord, &records, CONFIG_COMMONS_LOGGING_FRAMING_CRC);
+    decoder.Decode(stream.data(), stream.size());
+
+    CHECK(records.size() == 2);
+    if (records.size() == 2)
+    {
+        CheckRecord(records[0], message, 4, 21);
+        CheckRecord(records[1], message, 5, 22);
+    }
+
+    const LogFrameDecoderStats_t& stats = decoder.GetStats();
+    CHECK(stats.frameCount == 2);
+    CHECK((stats.crcErrorCount + stats.formatErrorCount) == 2);
+    CHECK(stats.sequenceGapCount == 0);
+}
+
+/**
+ * @brief Frames a batch with a log message too long for a frame, which is dropped and counted.
+ */
+static void TestDroppedLog()
+{
+    std::vector<uint8_t> message(CONFIG_COMMONS_LOGGING_BUFFER_SIZE, 'm');
+    std::vector<uint8_t> tooLong(LogFrame::cFrameSize, 'l');
+
+    LogRecord_t records[3] = {};
+    records[0].segments[0] = { .pData = message.data(), .length = message.size() };
+    records[1].segments[0] = { .pData = tooLong.data(), .length = tooLong.size() };
+    records[2].segments[0] = { .pData = message.data(), .length = message.size() };
+    for (size_t i = 0; i < 3; ++i)
+    {
+        records[i].segmentCount = 1;
+        records[i].level = 2;
+        records[i].sequenceNumber = static_cast<uint32_t>(30 + i);
+    }
+
+    LogRecord_t framedRecords[3];
+    static uint8_t frames[3][LogFrame::cFrameSize];
+    uint32_t droppedCount = LogFrame::GetDroppedCount();
+    size_t framedRecordCount = LogFrame::EncodeBatch(records, 3, framedRecords, frames);
+
+    CHECK(framedRecordCount == 2);
+    CHECK(LogFrame::GetDroppedCount() == (droppedCount + 1));
+    CHECK(framedRecords[1].sequenceNumber == 32);
+
+    std::vector<DecodedRecord_t> decodedRecords;
+    LogFrameDecoder decoder(OnRecord, &decodedRecords, CONFIG_COMMONS_LOGGING_FRAMING_CRC);
+    for (size_t i = 0; i < framedRecordCount; ++i)
+    {
+        decoder.Decode(framedRecords[i].segments[0].pData, framedRecords[i].segments[0].length);
+    }
+
+    CHECK(decodedRecords.size() == 2);
+    CHECK(decoder.GetStats().sequenceGapCount == 1);
+}
+
+// ----------------------------------------------------------------------------
+// Public functions
+// ----------------------------------------------------------------------------
+
+extern "C" void Assert_HandleAssert(const char* pFile, int line, uintptr_t caller)
+{
+    printf("%s:%d: assertion failed, caller %p\n", pFile, line, reinterpret_cast<void*>(caller));
+    abort();
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestFullBlock();
+#if CONFIG_COMMONS_LOGGING_FRAMING_CRC
+    TestBadCrc();
+#endif
+    TestResync();
+    TestDroppedLog();
+
+    if (gFailureCount > 0)
+    {
+        printf("%d checks failed\n", gFailureCount);
+        return EXIT_FAILURE;
+    }
+
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
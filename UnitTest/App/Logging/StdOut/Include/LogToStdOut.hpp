@@ -21,6 +21,8 @@ class LogToStdOut final: public LogToOutput
 {
 public:
 
+    using LogToOutput::ProcessLogMessage;
+
     /**
      * @brief Initialization.
      */
@@ -33,4 +35,21 @@ public:
      * @param[in] length Length of the log message.
      */
     void ProcessLogMessage(const uint8_t* pMessage, size_t length) override;
+
+    /**
+     * @brief Process a log message split in multiple segments and output them one after another.
+     *
+     * @param[in] pSegments Pointer to the segments of the log message.
+     * @param[in] segmentCount Number of segments.
+     */
+    void ProcessLogMessage(const LogSpan_t* pSegments, size_t segmentCount) override;
+
+#if CONFIG_COMMONS_LOGGING_TOKENIZED
+    /**
+     * @brief Receive the tokenized log messages Base64 encoded.
+     *
+     * @return LogOutputFormat_t Always LOG_OUTPUT_FORMAT_BASE64.
+     */
+    LogOutputFormat_t GetOutputFormat() const override;
+#endif
 };
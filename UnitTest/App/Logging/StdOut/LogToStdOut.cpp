@@ -27,18 +27,29 @@ void LogToStdOut::ProcessLogMessage(const uint8_t* pMessage, size_t length)
     ASSERT(pMessage != nullptr);
     ASSERT(length > 0);
 
-    const uint8_t* pLogMessage = pMessage;
-    size_t messageLength = length;
+    printf("%.*s\n", (int)length, pMessage);
+}
+
+void LogToStdOut::ProcessLogMessage(const LogSpan_t* pSegments, size_t segmentCount)
+{
+    ASSERT(pSegments != nullptr);
+    ASSERT(segmentCount > 0);
 
-#if CONFIG_COMMONS_LOGGING_BASE64_ENCODING
-    size_t base64MessageLength = 0;
-    const char* pBase64Message = ConvertToBase64(pLogMessage, messageLength, base64MessageLength);
-    if( pBase64Message != nullptr)
+    // The segments point into the log queue, they are printed in place without joining them.
+    // The stream stays locked, so that the log message is not interleaved with another one.
+    flockfile(stdout);
+    for (size_t i = 0; i < segmentCount; ++i)
     {
-        pLogMessage = reinterpret_cast<const uint8_t*>(pBase64Message);
-        messageLength = base64MessageLength;
+        fwrite(pSegments[i].pData, 1, pSegments[i].length, stdout);
     }
-#endif
+    fputc('\n', stdout);
+    funlockfile(stdout);
+}
 
-    printf("%.*s\n", (int)messageLength, pLogMessage);
+#if CONFIG_COMMONS_LOGGING_TOKENIZED
+LogOutputFormat_t LogToStdOut::GetOutputFormat() const
+{
+    // The standard output is text
+    return LOG_OUTPUT_FORMAT_BASE64;
 }
+#endif
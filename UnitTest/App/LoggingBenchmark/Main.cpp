@@ -0,0 +1,439 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Macro definitions
+// ----------------------------------------------------------------------------
+
+#define LOG_MODULE_NAME "Benchmark"
+
+// Name of the benchmarked configuration, set by the build
+#ifndef BENCHMARK_CONFIG_NAME
+#define BENCHMARK_CONFIG_NAME "unknown"
+#endif
+
+// Number of operations of every benchmark, large enough to hide the timer overhead
+#define BENCHMARK_OPERATION_COUNT       (200000)
+
+// Number of log messages pushed before they are pulled again in the queue benchmark
+#define BENCHMARK_QUEUE_BATCH_SIZE      (8)
+
+// Number of log messages encoded at once in the Base64 batch benchmark, as in a drained batch
+#define BENCHMARK_BASE64_BATCH_SIZE     (8)
+
+// Time without delivered log messages after which the deferred ones are considered dropped
+#define BENCHMARK_DELIVERY_TIMEOUT_MS   (100)
+
+// Size of the segment files of the file output benchmark, a few rotations per run
+#define BENCHMARK_FILE_SEGMENT_SIZE     (4 * 1024 * 1024)
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "CommonTypes.h"
+#include "Logging.h"
+#include "LogCore.hpp"
+#include "LogToNull.hpp"
+
+#if CONFIG_COMMONS_LOGGING_DEFERRED
+#include "LogQueue.hpp"
+#endif
+#if CONFIG_COMMONS_LOGGING_BASE64_ENCODING
+#include "LogBase64.hpp"
+#endif
+#if CONFIG_COMMONS_LOGGING_FRAMING
+#include "LogFrame.hpp"
+#endif
+#if CONFIG_COMMONS_LOGGING_FILE_OUTPUT
+#include "LogToFile.hpp"
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#if CONFIG_COMMONS_LOGGING_FILE_OUTPUT
+#include <filesystem>
+#include <string>
+#endif
+#include <thread>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Variable definitions
+// ----------------------------------------------------------------------------
+
+// Payload sizes of the log messages, from a short message to a full log buffer
+static const size_t gPayloadSizes[] = { 16, 64, CONFIG_COMMONS_LOGGING_BUFFER_SIZE };
+
+// Number of producer threads of the scaling benchmark
+static const size_t gThreadCounts[] = { 1, 2, 4, 8 };
+
+// Consumer receiving all the log messages
+static LogToNull gLogToNull;
+
+#if CONFIG_COMMONS_LOGGING_DEFERRED
+// Buffer of the log queues used by the log core
+static uint8_t gLogBuffer[16384];
+
+// Buffer of the log queue benchmarked on its own
+static uint8_t gQueueBuffer[4096];
+#endif
+
+// ----------------------------------------------------------------------------
+// Private functions
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Get the current time of the monotonic clock.
+ *
+ * @return uint64_t Time in nanoseconds.
+ */
+static uint64_t GetTimeNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Wait until the consumer received the expected number of log messages.
+ *
+ * In immediate mode the log messages are already delivered. In deferred mode the wait ends early
+ * when the log thread stops delivering, as the remaining log messages were dropped.
+ *
+ * @param[in] expectedCount Number of log messages the consumer should have received.
+ * @param[out] deliveryTime Time at which the last log message was received, in nanoseconds.
+ *
+ * @return uint64_t Number of log messages the consumer received.
+ */
+static uint64_t WaitForDelivery(uint64_t expectedCount, uint64_t &deliveryTime)
+{
+    uint64_t messageCount = gLogToNull.GetMessageCount();
+    uint64_t progressTime = GetTimeNs();
+
+    while (messageCount < expectedCount)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        uint64_t newMessageCount = gLogToNull.GetMessageCount();
+        if (newMessageCount != messageCount)
+        {
+            messageCount = newMessageCount;
+            progressTime = GetTimeNs();
+        }
+        else if ((GetTimeNs() - progressTime) > (BENCHMARK_DELIVERY_TIMEOUT_MS * 1000000ULL))
+        {
+            break;
+        }
+    }
+
+    deliveryTime = progressTime;
+
+    return messageCount;
+}
+
+/**
+ * @brief Print the result of a benchmark as a single JSON line.
+ *
+ * @param[in] pName Name of the benchmark.
+ * @param[in] payloadSize Size of the log messages in bytes, 0 if not applicable.
+ * @param[in] threadCount Number of producer threads.
+ * @param[in] operationCount Number of operations.
+ * @param[in] elapsedNs Time spent by the operations, in nanoseconds.
+ * @param[in] deliveredCount Number of log messages received by the consumer.
+ * @param[in] deliveredNs Time until the last log message was received, in nanoseconds.
+ */
+static void Report(const char* pName, size_t payloadSize, size_t threadCount, uint64_t operationCount,
+                   uint64_t elapsedNs, uint64_t deliveredCount, uint64_t deliveredNs)
+{
+    double nsPerOperation = static_cast<double>(elapsedNs) / static_cast<double>(operationCount);
+    double messagesPerSecond = (deliveredNs > 0) ? (static_cast<double>(deliveredCount) * 1e9 / static_cast<double>(deliveredNs)) : 0.0;
+
+    printf("{\"config\":\"%s\",\"benchmark\":\"%s\",\"payload\":%zu,\"threads\":%zu,\"operations\":%llu,"
+           "\"ns_per_op\":%.1f,\"msgs_per_s\":%.0f,\"delivered\":%llu}\n",
+           BENCHMARK_CONFIG_NAME, pName, payloadSize, threadCount, static_cast<unsigned long long>(operationCount),
+           nsPerOperation, messagesPerSecond, static_cast<unsigned long long>(deliveredCount));
+    fflush(stdout);
+}
+
+/**
+ * @brief Run a producer benchmark and report it.
+ *
+ * The time per operation only covers the producers, the message rate also covers the delivery
+ * to the consumer, which is what a deferred configuration can sustain.
+ *
+ * @param[in] pName Name of the benchmark.
+ * @param[in] payloadSize Size of the log messages in bytes, 0 if not applicable.
+ * @param[in] threadCount Number of producer threads.
+ * @param[in] produce Function producing the given number of log messages.
+ */
+template <typename Producer>
+static void RunProducerBenchmark(const char* pName, size_t payloadSize, size_t threadCount, Producer produce)
+{
+    uint64_t operationCount = BENCHMARK_OPERATION_COUNT - (BENCHMARK_OPERATION_COUNT % threadCount);
+    uint64_t initialCount = gLogToNull.GetMessageCount();
+    std::vector<std::thread> threads;
+
+    uint64_t startTime = GetTimeNs();
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back(produce, operationCount / threadCount);
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    uint64_t producedTime = GetTimeNs();
+
+    uint64_t deliveredTime = 0;
+    uint64_t deliveredCount = WaitForDelivery(initialCount + operationCount, deliveredTime) - initialCount;
+
+    Report(pName, payloadSize, threadCount, operationCount, producedTime - startTime, deliveredCount, deliveredTime - startTime);
+}
+
+#if CONFIG_COMMONS_LOGGING_DEFERRED
+/**
+ * @brief Benchmark a push and pull round trip through a log queue, without the log core.
+ *
+ * @param[in] payloadSize Size of the log messages in bytes.
+ */
+static void BenchmarkLogQueue(size_t payloadSize)
+{
+    static LogQueue logQueue;
+    uint8_t message[CONFIG_COMMONS_LOGGING_BUFFER_SIZE];
+    LogRecord_t record;
+    uint64_t pulledCount = 0;
+
+    memset(message, 'q', sizeof(message));
+    logQueue.Initialize(gQueueBuffer, sizeof(gQueueBuffer));
+
+    uint64_t startTime = GetTimeNs();
+    for (size_t i = 0; i < BENCHMARK_OPERATION_COUNT; i += BENCHMARK_QUEUE_BATCH_SIZE)
+    {
+        for (size_t j = 0; j < BENCHMARK_QUEUE_BATCH_SIZE; ++j)
+        {
+            logQueue.PushLog(message, payloadSize, LOG_LEVEL_INFO);
+        }
+
+        while (logQueue.PeekLog(record) == 0)
+        {
+            ++pulledCount;
+        }
+        logQueue.ReleaseLogs();
+    }
+    uint64_t elapsedTime = GetTimeNs() - startTime;
+
+    Report("queue_push_pull", payloadSize, 1, BENCHMARK_OPERATION_COUNT, elapsedTime, pulledCount, elapsedTime);
+}
+#endif
+
+/**
+ * @brief Benchmark the log core with preformatted log messages, without a producer.
+ *
+ * @param[in] payloadSize Size of the log messages in bytes.
+ */
+static void BenchmarkHandleLogMessage(size_t payloadSize)
+{
+    RunProducerBenchmark("handle_log_message", payloadSize, 1, [payloadSize](uint64_t count)
+    {
+        uint8_t message[CONFIG_COMMONS_LOGGING_BUFFER_SIZE];
+        memset(message, 'h', sizeof(message));
+
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            LogCore::HandleLogMessage(message, payloadSize, LOG_LEVEL_INFO);
+        }
+    });
+}
+
+/**
+ * @brief Benchmark the configured producer, string or tokenized, through the logging macros.
+ *
+ * @param[in] threadCount Number of producer threads.
+ */
+static void BenchmarkProducer(size_t threadCount)
+{
+    RunProducerBenchmark("producer", 0, threadCount, [](uint64_t count)
+    {
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            LOG_INFO("Benchmark message %u of %u", static_cast<unsigned int>(i), static_cast<unsigned int>(count));
+        }
+    });
+}
+
+#if CONFIG_COMMONS_LOGGING_BASE64_ENCODING
+/**
+ * @brief Benchmark the Base64 encoding of tokenized log messages, one by one and by batch.
+ *
+ * @param[in] payloadSize Size of the log messages in bytes.
+ */
+static void BenchmarkBase64(size_t payloadSize)
+{
+    static char encodedMessages[BENCHMARK_BASE64_BATCH_SIZE][LogBase64::cMessageSize];
+    uint8_t message[CONFIG_COMMONS_LOGGING_BUFFER_SIZE];
+    LogRecord_t records[BENCHMARK_BASE64_BATCH_SIZE] = {};
+    LogRecord_t encodedRecords[BENCHMARK_BASE64_BATCH_SIZE];
+    volatile size_t encodedLength = 0;
+
+    for (size_t i = 0; i < sizeof(message); ++i)
+    {
+        message[i] = static_cast<uint8_t>(i * 37);
+    }
+
+    // The log message wraps around the end of the queue buffer in the middle
+    LogSpan_t segments[2] = { { .pData = message, .length = payloadSize / 2 },
+                              { .pData = message + (payloadSize / 2), .length = payloadSize - (payloadSize / 2) } };
+
+    uint64_t startTime = GetTimeNs();
+    for (size_t i = 0; i < BENCHMARK_OPERATION_COUNT; ++i)
+    {
+        encodedLength = LogBase64::Encode(segments, 2, encodedMessages[0], sizeof(encodedMessages[0]));
+    }
+    uint64_t elapsedTime = GetTimeNs() - startTime;
+
+    UNUSED(encodedLength);
+    Report("base64_encode", payloadSize, 1, BENCHMARK_OPERATION_COUNT, elapsedTime, BENCHMARK_OPERATION_COUNT, elapsedTime);
+
+    for (LogRecord_t &record : records)
+    {
+        record.segments[0] = segments[0];
+        record.segments[1] = segments[1];
+        record.segmentCount = 2;
+    }
+
+    startTime = GetTimeNs();
+    for (size_t i = 0; i < BENCHMARK_OPERATION_COUNT; i += BENCHMARK_BASE64_BATCH_SIZE)
+    {
+        LogBase64::EncodeBatch(records, BENCHMARK_BASE64_BATCH_SIZE, encodedRecords, encodedMessages);
+    }
+    elapsedTime = GetTimeNs() - startTime;
+
+    Report("base64_encode_batch", payloadSize, 1, BENCHMARK_OPERATION_COUNT, elapsedTime, BENCHMARK_OPERATION_COUNT, elapsedTime);
+}
+#endif
+
+#if CONFIG_COMMONS_LOGGING_FRAMING
+/**
+ * @brief Benchmark the framing of tokenized log messages with their metadata.
+ *
+ * @param[in] payloadSize Size of the log messages in bytes.
+ */
+static void BenchmarkFraming(size_t payloadSize)
+{
+    static uint8_t frame[LogFrame::cFrameSize];
+    uint8_t message[CONFIG_COMMONS_LOGGING_BUFFER_SIZE];
+    LogRecord_t record = {};
+    volatile size_t frameLength = 0;
+
+    // Distinct byte values, a zero byte included, as in the encoded arguments of a tokenized log message
+    for (size_t i = 0; i < sizeof(message); ++i)
+    {
+        message[i] = static_cast<uint8_t>(i * 37);
+    }
+
+    // The log message wraps around the end of the queue buffer in the middle
+    record.segments[0] = { .pData = message, .length = payloadSize / 2 };
+    record.segments[1] = { .pData = message + (payloadSize / 2), .length = payloadSize - (payloadSize / 2) };
+    record.segmentCount = 2;
+    record.level = LOG_LEVEL_INFO;
+
+    uint64_t startTime = GetTimeNs();
+    for (size_t i = 0; i < BENCHMARK_OPERATION_COUNT; ++i)
+    {
+        record.sequenceNumber = static_cast<uint32_t>(i);
+        frameLength = LogFrame::Encode(record, frame, sizeof(frame));
+    }
+    uint64_t elapsedTime = GetTimeNs() - startTime;
+
+    UNUSED(frameLength);
+    Report("frame_encode", payloadSize, 1, BENCHMARK_OPERATION_COUNT, elapsedTime, BENCHMARK_OPERATION_COUNT, elapsedTime);
+}
+#endif
+
+#if CONFIG_COMMONS_LOGGING_FILE_OUTPUT
+/**
+ * @brief Benchmark the output of log messages to memory mapped segment files, rotations included.
+ *
+ * @param[in] payloadSize Size of the log messages in bytes.
+ */
+static void BenchmarkFileOutput(size_t payloadSize)
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "LoggingBenchmark";
+    std::filesystem::create_directories(directory);
+
+    std::string path = (directory / "benchmark.log").string();
+    LogToFile logToFile(path.c_str(), BENCHMARK_FILE_SEGMENT_SIZE, 2);
+    uint8_t message[CONFIG_COMMONS_LOGGING_BUFFER_SIZE];
+
+    memset(message, 'f', sizeof(message));
+    logToFile.Initialize();
+
+    uint64_t startTime = GetTimeNs();
+    for (size_t i = 0; i < BENCHMARK_OPERATION_COUNT; ++i)
+    {
+        logToFile.ProcessLogMessage(message, payloadSize);
+    }
+    uint64_t elapsedTime = GetTimeNs() - startTime;
+
+    uint64_t writtenCount = BENCHMARK_OPERATION_COUNT - logToFile.GetDroppedCount();
+    logToFile.Close();
+    std::filesystem::remove_all(directory);
+
+    Report("file_write", payloadSize, 1, BENCHMARK_OPERATION_COUNT, elapsedTime, writtenCount, elapsedTime);
+}
+#endif
+
+// ----------------------------------------------------------------------------
+// Main function
+// ----------------------------------------------------------------------------
+
+int main(void)
+{
+    // Register the consumer
+    LogCore::RegisterConsumer(LogToNull::cId, gLogToNull);
+
+#if CONFIG_COMMONS_LOGGING_DEFERRED
+    LogCore::InitializeQueue(gLogBuffer, sizeof(gLogBuffer));
+
+    for (size_t payloadSize : gPayloadSizes)
+    {
+        BenchmarkLogQueue(payloadSize);
+    }
+#endif
+
+    for (size_t payloadSize : gPayloadSizes)
+    {
+        BenchmarkHandleLogMessage(payloadSize);
+    }
+
+#if CONFIG_COMMONS_LOGGING_BASE64_ENCODING
+    for (size_t payloadSize : gPayloadSizes)
+    {
+        BenchmarkBase64(payloadSize);
+    }
+#endif
+
+#if CONFIG_COMMONS_LOGGING_FRAMING
+    for (size_t payloadSize : gPayloadSizes)
+    {
+        BenchmarkFraming(payloadSize);
+    }
+#endif
+
+#if CONFIG_COMMONS_LOGGING_FILE_OUTPUT
+    for (size_t payloadSize : gPayloadSizes)
+    {
+        BenchmarkFileOutput(payloadSize);
+    }
+#endif
+
+    for (size_t threadCount : gThreadCounts)
+    {
+        BenchmarkProducer(threadCount);
+    }
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+#pragma once
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "LogToOutput.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+// Class definition
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Consumer which discards the log messages, so that the benchmarks exclude the output cost.
+ *
+ * It only counts the log messages, so that the benchmarks can wait for the deferred ones.
+ */
+class LogToNull final: public LogToOutput
+{
+public:
+
+    using LogToOutput::ProcessLogMessage;
+
+    // Identifier of the consumer
+    static constexpr uint8_t cId = 0;
+
+    /**
+     * @brief Initialization.
+     */
+    void Initialize() override;
+
+    /**
+     * @brief Count a log message and discard it.
+     *
+     * @param[in] pMessage Pointer to the log message.
+     * @param[in] length Length of the log message.
+     */
+    void ProcessLogMessage(const uint8_t* pMessage, size_t length) override;
+
+    /**
+     * @brief Get the number of log messages received so far.
+     *
+     * @return uint64_t Number of log messages.
+     */
+    uint64_t GetMessageCount() const;
+
+private:
+
+    std::atomic<uint64_t> mMessageCount = 0;    // Number of log messages received
+};
@@ -0,0 +1,35 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Author: Manoj Kumar Paladugu <paladugumanojkumar@gmail.com>
+ */
+
+// ----------------------------------------------------------------------------
+// Header includes
+// ----------------------------------------------------------------------------
+
+#include "CommonTypes.h"
+#include "LogToNull.hpp"
+
+// ----------------------------------------------------------------------------
+// Public functions
+// ----------------------------------------------------------------------------
+
+void LogToNull::Initialize()
+{
+    // Initialization if needed.
+}
+
+void LogToNull::ProcessLogMessage(const uint8_t* pMessage, size_t length)
+{
+    UNUSED(pMessage);
+    UNUSED(length);
+
+    // Producers may run in parallel in immediate mode, the count only needs to be atomic
+    mMessageCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t LogToNull::GetMessageCount() const
+{
+    return mMessageCount.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,10 @@
+#!/bin/bash
+
+# Every logging mode is a separate build, the results are printed as one JSON object per line
+for config in "immediate OFF" "immediate ON" "deferred OFF" "deferred ON"; do
+    set -- $config
+    build_dir=App/LoggingBenchmark/_out/$1-$2
+    cmake -S App/LoggingBenchmark -B $build_dir -DBENCHMARK_MODE=$1 -DBENCHMARK_TOKENIZED=$2 > /dev/null
+    cmake --build $build_dir > /dev/null
+    $build_dir/benchmark
+done